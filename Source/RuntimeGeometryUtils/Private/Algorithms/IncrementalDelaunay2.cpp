@@ -0,0 +1,837 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../../Public/Algorithms/IncrementalDelaunay2.h"
+#include "../../Public/Algorithms/PointTriangleRelation.h"
+
+using namespace UE::Geometry;
+
+namespace IncrementalDelaunay2Local
+{
+	// the super triangle is far enough that its circumcircles behave like half-planes at MaxCoordinate
+	static constexpr float SuperTriangleSize = 1.0e16f;
+
+	// true if the open segments PQ and AB cross at a single interior point
+	static bool SegmentsCross(const FVector2f& P, const FVector2f& Q, const FVector2f& A, const FVector2f& B)
+	{
+		const double OP = PointTriangleRelation::Orient2D(A, B, P), OQ = PointTriangleRelation::Orient2D(A, B, Q);
+		const double OA = PointTriangleRelation::Orient2D(P, Q, A), OB = PointTriangleRelation::Orient2D(P, Q, B);
+		return ((OP < 0 && OQ > 0) || (OP > 0 && OQ < 0)) && ((OA < 0 && OB > 0) || (OA > 0 && OB < 0));
+	}
+
+	static int32 IndexOf(const FIndex3i& Tri, int32 VertexID)
+	{
+		return (Tri.A == VertexID) ? 0 : (Tri.B == VertexID) ? 1 : (Tri.C == VertexID) ? 2 : -1;
+	}
+}
+
+
+FIncrementalDelaunay2::FIncrementalDelaunay2()
+{
+	Reset();
+}
+
+
+void FIncrementalDelaunay2::Reset()
+{
+	using namespace IncrementalDelaunay2Local;
+
+	Vertices.Reset();
+	VertexRefCounts.Reset();
+	VertexTriangles.Reset();
+	FreeVertices.Reset();
+	Triangles.Reset();
+	TriangleNeighbors.Reset();
+	TriangleAlive.Reset();
+	FreeTriangles.Reset();
+	ConstrainedEdges.Reset();
+
+	// previously output triangles are reported as changed
+	for (int32 tid = 0; tid < TriangleOutput.Num(); ++tid)
+	{
+		if (TriangleOutput[tid])
+		{
+			ChangedTriangles.Add(tid);
+		}
+	}
+
+	// counter-clockwise super triangle
+	Vertices.Add(FVector2f(-SuperTriangleSize, -SuperTriangleSize));
+	Vertices.Add(FVector2f(SuperTriangleSize, -SuperTriangleSize));
+	Vertices.Add(FVector2f(0, SuperTriangleSize));
+	VertexRefCounts.Init(1, NumSuperVertices);
+	VertexTriangles.Init(0, NumSuperVertices);
+
+	const int32 tid = AllocateTriangle();
+	SetTriangle(tid, FIndex3i(0, 1, 2), FIndex3i(-1, -1, -1));
+	LastTriangle = tid;
+}
+
+
+int32 FIncrementalDelaunay2::AllocateVertex(const FVector2f& Position)
+{
+	int32 VertexID;
+	if (FreeVertices.Num() > 0)
+	{
+		VertexID = FreeVertices.Pop(EAllowShrinking::No);
+		Vertices[VertexID] = Position;
+		VertexRefCounts[VertexID] = 1;
+		VertexTriangles[VertexID] = -1;
+	}
+	else
+	{
+		VertexID = Vertices.Add(Position);
+		VertexRefCounts.Add(1);
+		VertexTriangles.Add(-1);
+	}
+	return VertexID;
+}
+
+
+int32 FIncrementalDelaunay2::AllocateTriangle()
+{
+	int32 TriangleID;
+	if (FreeTriangles.Num() > 0)
+	{
+		TriangleID = FreeTriangles.Pop(EAllowShrinking::No);
+		TriangleAlive[TriangleID] = true;
+	}
+	else
+	{
+		TriangleID = Triangles.Add(FIndex3i(-1, -1, -1));
+		TriangleNeighbors.Add(FIndex3i(-1, -1, -1));
+		TriangleAlive.Add(true);
+	}
+	ChangedTriangles.Add(TriangleID);
+	return TriangleID;
+}
+
+
+void FIncrementalDelaunay2::FreeTriangle(int32 TriangleID)
+{
+	TriangleAlive[TriangleID] = false;
+	FreeTriangles.Add(TriangleID);
+	ChangedTriangles.Add(TriangleID);
+}
+
+
+void FIncrementalDelaunay2::SetTriangle(int32 TriangleID, const FIndex3i& Tri, const FIndex3i& Neighbors)
+{
+	Triangles[TriangleID] = Tri;
+	TriangleNeighbors[TriangleID] = Neighbors;
+	VertexTriangles[Tri.A] = VertexTriangles[Tri.B] = VertexTriangles[Tri.C] = TriangleID;
+	ChangedTriangles.Add(TriangleID);
+}
+
+
+void FIncrementalDelaunay2::LinkNeighbor(int32 TriangleID, int32 Edge, int32 Neighbor)
+{
+	TriangleNeighbors[TriangleID][Edge] = Neighbor;
+	if (Neighbor >= 0)
+	{
+		const int32 A = Triangles[TriangleID][Edge], B = Triangles[TriangleID][(Edge + 1) % 3];
+		const FIndex3i& NbrTri = Triangles[Neighbor];
+		for (int32 f = 0; f < 3; ++f)
+		{
+			if (NbrTri[f] == B && NbrTri[(f + 1) % 3] == A)
+			{
+				TriangleNeighbors[Neighbor][f] = TriangleID;
+			}
+		}
+	}
+}
+
+
+void FIncrementalDelaunay2::GetVertexTriangles(int32 VertexID, TArray<int32>& TrianglesOut) const
+{
+	using namespace IncrementalDelaunay2Local;
+
+	TrianglesOut.Reset();
+	const int32 Start = VertexTriangles[VertexID];
+	int32 Current = Start;
+	do
+	{
+		TrianglesOut.Add(Current);
+		const int32 i = IndexOf(Triangles[Current], VertexID);
+		Current = TriangleNeighbors[Current][(i + 2) % 3];
+	} while (Current >= 0 && Current != Start);
+
+	if (Current < 0)
+	{
+		// open ring around a super triangle vertex, add the triangles clockwise from the start
+		Current = Start;
+		while (true)
+		{
+			const int32 i = IndexOf(Triangles[Current], VertexID);
+			Current = TriangleNeighbors[Current][i];
+			if (Current < 0)
+			{
+				break;
+			}
+			TrianglesOut.Insert(Current, 0);
+		}
+	}
+}
+
+
+int32 FIncrementalDelaunay2::FindEdge(int32 A, int32 B, int32& EdgeOut) const
+{
+	using namespace IncrementalDelaunay2Local;
+
+	const int32 Start = VertexTriangles[A];
+	int32 Current = Start;
+	int32 Steps = 0;
+	while (Current >= 0 && Steps++ < Triangles.Num())
+	{
+		const int32 i = IndexOf(Triangles[Current], A);
+		if (Triangles[Current][(i + 1) % 3] == B)
+		{
+			EdgeOut = i;
+			return Current;
+		}
+		Current = TriangleNeighbors[Current][(i + 2) % 3];
+		if (Current == Start)
+		{
+			return -1;
+		}
+	}
+
+	// open ring, search clockwise
+	Current = Start;
+	while (Current >= 0 && Steps++ < 2 * Triangles.Num())
+	{
+		const int32 i = IndexOf(Triangles[Current], A);
+		if (Triangles[Current][(i + 1) % 3] == B)
+		{
+			EdgeOut = i;
+			return Current;
+		}
+		Current = TriangleNeighbors[Current][i];
+	}
+	return -1;
+}
+
+
+int32 FIncrementalDelaunay2::LocateTriangle(const FVector2f& Position) const
+{
+	// Stochastic visibility walk from the last modified triangle: cross the first edge that has the point on its outer
+	// side, in a random edge order, as a deterministic walk can cycle in a non-Delaunay triangulation
+	int32 Current = IsTriangle(LastTriangle) ? LastTriangle : TriangleAlive.Find(true);
+	uint32 Random = (uint32)Current * 2654435761u + 1;
+	for (int32 Step = 0, MaxSteps = Triangles.Num(); Current >= 0 && Step < MaxSteps; ++Step)
+	{
+		const FIndex3i& Tri = Triangles[Current];
+		Random = Random * 1664525u + 1013904223u;
+		const int32 FirstEdge = (int32)((Random >> 16) % 3);
+		int32 Next = Current;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			const int32 e = (FirstEdge + i) % 3;
+			if (PointTriangleRelation::Orient2D(Vertices[Tri[e]], Vertices[Tri[(e + 1) % 3]], Position) < 0)
+			{
+				Next = TriangleNeighbors[Current][e];
+				break;
+			}
+		}
+		if (Next == Current)
+		{
+			return Current;
+		}
+		Current = Next;
+	}
+
+	for (int32 tid = 0; tid < Triangles.Num(); ++tid)
+	{
+		int32 EdgeOrVertex;
+		if (TriangleAlive[tid] && PointTriangleRelation::ClassifyPointInTriangle2D(Position,
+			Vertices[Triangles[tid].A], Vertices[Triangles[tid].B], Vertices[Triangles[tid].C], EdgeOrVertex) != EPointTriangleLocation::Outside)
+		{
+			return tid;
+		}
+	}
+	return -1;
+}
+
+
+void FIncrementalDelaunay2::SplitTriangle(int32 TriangleID, int32 VertexID, TArray<TPair<int32, int32>>& EdgeStack)
+{
+	// (A,B,C) -> (A,B,P) in place, (B,C,P) and (C,A,P) added
+	const FIndex3i Tri = Triangles[TriangleID];
+	const FIndex3i Nbrs = TriangleNeighbors[TriangleID];
+	const int32 T1 = AllocateTriangle(), T2 = AllocateTriangle();
+
+	SetTriangle(TriangleID, FIndex3i(Tri.A, Tri.B, VertexID), FIndex3i(Nbrs.A, T1, T2));
+	SetTriangle(T1, FIndex3i(Tri.B, Tri.C, VertexID), FIndex3i(-1, T2, TriangleID));
+	SetTriangle(T2, FIndex3i(Tri.C, Tri.A, VertexID), FIndex3i(-1, TriangleID, T1));
+	LinkNeighbor(T1, 0, Nbrs.B);
+	LinkNeighbor(T2, 0, Nbrs.C);
+
+	EdgeStack.Add(TPair<int32, int32>(TriangleID, 0));
+	EdgeStack.Add(TPair<int32, int32>(T1, 0));
+	EdgeStack.Add(TPair<int32, int32>(T2, 0));
+}
+
+
+void FIncrementalDelaunay2::SplitEdge(int32 TriangleID, int32 Edge, int32 VertexID, TArray<TPair<int32, int32>>& EdgeStack)
+{
+	using namespace IncrementalDelaunay2Local;
+
+	// T = (A,B,C) -> (P,B,C) in place and (A,P,C) added; the neighbor M = (B,A,D) -> (P,A,D) in place and (B,P,D) added
+	const int32 T = TriangleID;
+	const int32 A = Triangles[T][Edge], B = Triangles[T][(Edge + 1) % 3], C = Triangles[T][(Edge + 2) % 3];
+	const int32 TNbrBC = TriangleNeighbors[T][(Edge + 1) % 3], TNbrCA = TriangleNeighbors[T][(Edge + 2) % 3];
+	const int32 M = TriangleNeighbors[T][Edge];
+
+	// a split constrained edge stays constrained in both halves
+	int32 ConstraintCount = 0;
+	if (ConstrainedEdges.RemoveAndCopyValue(EdgeKey(A, B), ConstraintCount))
+	{
+		ConstrainedEdges.Add(EdgeKey(A, VertexID), ConstraintCount);
+		ConstrainedEdges.Add(EdgeKey(VertexID, B), ConstraintCount);
+	}
+
+	const int32 T1 = AllocateTriangle();
+	SetTriangle(T, FIndex3i(VertexID, B, C), FIndex3i(-1, TNbrBC, T1));
+	SetTriangle(T1, FIndex3i(A, VertexID, C), FIndex3i(-1, T, -1));
+	LinkNeighbor(T1, 2, TNbrCA);
+	EdgeStack.Add(TPair<int32, int32>(T, 1));
+	EdgeStack.Add(TPair<int32, int32>(T1, 2));
+
+	if (M >= 0)
+	{
+		const int32 f = IndexOf(Triangles[M], B);
+		const int32 D = Triangles[M][(f + 2) % 3];
+		const int32 MNbrAD = TriangleNeighbors[M][(f + 1) % 3], MNbrDB = TriangleNeighbors[M][(f + 2) % 3];
+
+		const int32 M1 = AllocateTriangle();
+		SetTriangle(M, FIndex3i(VertexID, A, D), FIndex3i(T1, MNbrAD, M1));
+		SetTriangle(M1, FIndex3i(B, VertexID, D), FIndex3i(T, M, -1));
+		LinkNeighbor(M1, 2, MNbrDB);
+		LinkNeighbor(T, 0, M1);
+		LinkNeighbor(T1, 0, M);
+		EdgeStack.Add(TPair<int32, int32>(M, 1));
+		EdgeStack.Add(TPair<int32, int32>(M1, 2));
+	}
+}
+
+
+void FIncrementalDelaunay2::FlipEdge(int32 T, int32 Edge)
+{
+	using namespace IncrementalDelaunay2Local;
+
+	const int32 M = TriangleNeighbors[T][Edge];
+	const int32 A = Triangles[T][Edge], B = Triangles[T][(Edge + 1) % 3], P = Triangles[T][(Edge + 2) % 3];
+	const int32 f = IndexOf(Triangles[M], B);
+	const int32 D = Triangles[M][(f + 2) % 3];
+	const int32 TNbrBP = TriangleNeighbors[T][(Edge + 1) % 3], TNbrPA = TriangleNeighbors[T][(Edge + 2) % 3];
+	const int32 MNbrAD = TriangleNeighbors[M][(f + 1) % 3], MNbrDB = TriangleNeighbors[M][(f + 2) % 3];
+
+	SetTriangle(T, FIndex3i(P, A, D), FIndex3i(TNbrPA, -1, M));
+	SetTriangle(M, FIndex3i(D, B, P), FIndex3i(-1, TNbrBP, T));
+	LinkNeighbor(T, 1, MNbrAD);
+	LinkNeighbor(M, 0, MNbrDB);
+	LinkNeighbor(M, 1, TNbrBP);
+}
+
+
+void FIncrementalDelaunay2::LegalizeEdges(TArray<TPair<int32, int32>>& EdgeStack)
+{
+	using namespace IncrementalDelaunay2Local;
+
+	while (EdgeStack.Num() > 0)
+	{
+		const TPair<int32, int32> Edge = EdgeStack.Pop(EAllowShrinking::No);
+		const int32 T = Edge.Key, e = Edge.Value;
+		const int32 M = TriangleNeighbors[T][e];
+		if (M < 0 || TriangleAlive[T] == false)
+		{
+			continue;
+		}
+
+		const int32 A = Triangles[T][e], B = Triangles[T][(e + 1) % 3], P = Triangles[T][(e + 2) % 3];
+		if (IsConstrainedEdge(A, B))
+		{
+			continue;
+		}
+		const int32 D = Triangles[M][(IndexOf(Triangles[M], B) + 2) % 3];
+		if (PointTriangleRelation::InCircle2D(Vertices[A], Vertices[B], Vertices[P], Vertices[D]) <= 0)
+		{
+			continue;
+		}
+
+		// T = (P,A,D), M = (D,B,P). After a point insertion only the edges opposite P can become illegal, but
+		// constraint insertion and vertex removal legalize arbitrary edges, so all four outer edges are checked
+		FlipEdge(T, e);
+		EdgeStack.Add(TPair<int32, int32>(T, 0));
+		EdgeStack.Add(TPair<int32, int32>(T, 1));
+		EdgeStack.Add(TPair<int32, int32>(M, 0));
+		EdgeStack.Add(TPair<int32, int32>(M, 1));
+	}
+}
+
+
+int32 FIncrementalDelaunay2::InsertVertex(const FVector2f& Position)
+{
+	if (FMath::Abs(Position.X) > MaxCoordinate || FMath::Abs(Position.Y) > MaxCoordinate)
+	{
+		return -1;
+	}
+
+	const int32 TriangleID = LocateTriangle(Position);
+	if (TriangleID < 0)
+	{
+		return -1;
+	}
+
+	const FIndex3i Tri = Triangles[TriangleID];
+	int32 EdgeOrVertex;
+	const EPointTriangleLocation Location = PointTriangleRelation::ClassifyPointInTriangle2D(Position,
+		Vertices[Tri.A], Vertices[Tri.B], Vertices[Tri.C], EdgeOrVertex);
+	if (Location == EPointTriangleLocation::OnVertex)
+	{
+		VertexRefCounts[Tri[EdgeOrVertex]]++;
+		return Tri[EdgeOrVertex];
+	}
+	if (Location == EPointTriangleLocation::Outside)
+	{
+		return -1;
+	}
+
+	const int32 VertexID = AllocateVertex(Position);
+	TArray<TPair<int32, int32>> EdgeStack;
+	if (Location == EPointTriangleLocation::Inside)
+	{
+		SplitTriangle(TriangleID, VertexID, EdgeStack);
+	}
+	else
+	{
+		SplitEdge(TriangleID, EdgeOrVertex, VertexID, EdgeStack);
+	}
+	LegalizeEdges(EdgeStack);
+	LastTriangle = VertexTriangles[VertexID];
+	return VertexID;
+}
+
+
+bool FIncrementalDelaunay2::RemoveVertex(int32 VertexID)
+{
+	using namespace IncrementalDelaunay2Local;
+
+	if (IsVertex(VertexID) == false)
+	{
+		return false;
+	}
+	if (VertexRefCounts[VertexID] > 1)
+	{
+		VertexRefCounts[VertexID]--;
+		return true;
+	}
+
+	TArray<int32> Star;
+	GetVertexTriangles(VertexID, Star);
+
+	// ring of the star, counter-clockwise, with the triangle across each ring edge (Vertex, next Vertex)
+	struct FRingNode
+	{
+		int32 Vertex;
+		int32 EdgeNeighbor;
+	};
+	TArray<FRingNode> Ring;
+	TArray<int32, TInlineAllocator<2>> ConstrainedNeighbors;
+	for (int32 tid : Star)
+	{
+		const int32 i = IndexOf(Triangles[tid], VertexID);
+		const int32 RingVertex = Triangles[tid][(i + 1) % 3];
+		Ring.Add({ RingVertex, TriangleNeighbors[tid][(i + 1) % 3] });
+		if (IsConstrainedEdge(VertexID, RingVertex))
+		{
+			ConstrainedNeighbors.Add(RingVertex);
+		}
+	}
+
+	// a vertex inside a straight constraint can be removed, the constraint is restored between its neighbors
+	int32 RestoreConstraintCount = 0;
+	if (ConstrainedNeighbors.Num() > 0)
+	{
+		const bool bInsideConstraint = ConstrainedNeighbors.Num() == 2
+			&& ConstrainedEdges[EdgeKey(VertexID, ConstrainedNeighbors[0])] == ConstrainedEdges[EdgeKey(VertexID, ConstrainedNeighbors[1])]
+			&& PointTriangleRelation::Orient2D(Vertices[ConstrainedNeighbors[0]], Vertices[ConstrainedNeighbors[1]], Vertices[VertexID]) == 0;
+		if (bInsideConstraint == false)
+		{
+			return false;
+		}
+		RestoreConstraintCount = ConstrainedEdges[EdgeKey(VertexID, ConstrainedNeighbors[0])];
+		ConstrainedEdges.Remove(EdgeKey(VertexID, ConstrainedNeighbors[0]));
+		ConstrainedEdges.Remove(EdgeKey(VertexID, ConstrainedNeighbors[1]));
+	}
+
+	for (int32 tid : Star)
+	{
+		FreeTriangle(tid);
+	}
+	VertexRefCounts[VertexID] = 0;
+	VertexTriangles[VertexID] = -1;
+	FreeVertices.Add(VertexID);
+
+	// Re-triangulate the star polygon by ear clipping. Ears whose circumcircle is empty are preferred, they are
+	// Delaunay triangles; the new edges are legalized afterwards in any case
+	TArray<TPair<int32, int32>> EdgeStack;
+	while (Ring.Num() > 3)
+	{
+		int32 BestEar = -1, FirstConvex = -1;
+		for (int32 k = 0; k < Ring.Num(); ++k)
+		{
+			const int32 P = Ring[(k + Ring.Num() - 1) % Ring.Num()].Vertex, C = Ring[k].Vertex, N = Ring[(k + 1) % Ring.Num()].Vertex;
+			const double Area = PointTriangleRelation::Orient2D(Vertices[P], Vertices[C], Vertices[N]);
+			if (Area <= 0)
+			{
+				continue;
+			}
+			FirstConvex = (FirstConvex < 0) ? k : FirstConvex;
+
+			bool bEmpty = true, bDelaunay = true;
+			for (int32 j = 0; j < Ring.Num() && bEmpty; ++j)
+			{
+				const int32 Q = Ring[j].Vertex;
+				if (Q == P || Q == C || Q == N)
+				{
+					continue;
+				}
+				int32 EdgeOrVertex;
+				bEmpty = PointTriangleRelation::ClassifyPointInTriangle2D(Vertices[Q], Vertices[P], Vertices[C], Vertices[N], EdgeOrVertex) == EPointTriangleLocation::Outside;
+				bDelaunay = bDelaunay && PointTriangleRelation::InCircle2D(Vertices[P], Vertices[C], Vertices[N], Vertices[Q]) <= 0;
+			}
+			if (bEmpty && bDelaunay)
+			{
+				BestEar = k;
+				break;
+			}
+			if (bEmpty && BestEar < 0)
+			{
+				BestEar = k;
+			}
+		}
+		if (BestEar < 0)
+		{
+			// there is always an ear of a simple polygon, this only guards against infinite loops
+			BestEar = FMath::Max(FirstConvex, 0);
+		}
+
+		const int32 Prev = (BestEar + Ring.Num() - 1) % Ring.Num();
+		const int32 Next = (BestEar + 1) % Ring.Num();
+		const int32 NewTri = AllocateTriangle();
+		SetTriangle(NewTri, FIndex3i(Ring[Prev].Vertex, Ring[BestEar].Vertex, Ring[Next].Vertex), FIndex3i(-1, -1, -1));
+		LinkNeighbor(NewTri, 0, Ring[Prev].EdgeNeighbor);
+		LinkNeighbor(NewTri, 1, Ring[BestEar].EdgeNeighbor);
+		EdgeStack.Add(TPair<int32, int32>(NewTri, 0));
+		EdgeStack.Add(TPair<int32, int32>(NewTri, 1));
+
+		// edge (Prev, Next) of the remaining polygon now borders the new triangle
+		Ring[Prev].EdgeNeighbor = NewTri;
+		Ring.RemoveAt(BestEar);
+	}
+
+	const int32 LastTri = AllocateTriangle();
+	SetTriangle(LastTri, FIndex3i(Ring[0].Vertex, Ring[1].Vertex, Ring[2].Vertex), FIndex3i(-1, -1, -1));
+	for (int32 e = 0; e < 3; ++e)
+	{
+		LinkNeighbor(LastTri, e, Ring[e].EdgeNeighbor);
+		EdgeStack.Add(TPair<int32, int32>(LastTri, e));
+	}
+	LegalizeEdges(EdgeStack);
+	LastTriangle = LastTri;
+
+	if (RestoreConstraintCount > 0)
+	{
+		if (InsertConstraintSegment(ConstrainedNeighbors[0], ConstrainedNeighbors[1], 0))
+		{
+			ConstrainedEdges.FindOrAdd(EdgeKey(ConstrainedNeighbors[0], ConstrainedNeighbors[1])) = RestoreConstraintCount;
+		}
+	}
+	return true;
+}
+
+
+bool FIncrementalDelaunay2::InsertConstraint(int32 VertexA, int32 VertexB)
+{
+	if (IsVertex(VertexA) == false || IsVertex(VertexB) == false || VertexA == VertexB)
+	{
+		return false;
+	}
+	return InsertConstraintSegment(VertexA, VertexB, 0);
+}
+
+
+bool FIncrementalDelaunay2::InsertConstraintSegment(int32 A, int32 B, int32 Depth)
+{
+	using namespace IncrementalDelaunay2Local;
+
+	int32 Edge;
+	if (FindEdge(A, B, Edge) >= 0 || FindEdge(B, A, Edge) >= 0)
+	{
+		ConstrainedEdges.FindOrAdd(EdgeKey(A, B), 0)++;
+		return true;
+	}
+	if (Depth > VertexRefCounts.Num())
+	{
+		return false;
+	}
+
+	const FVector2f& PA = Vertices[A];
+	const FVector2f& PB = Vertices[B];
+	const FVector2f Direction = PB - PA;
+
+	// find the triangle around A that the segment leaves through, or a vertex on the segment
+	TArray<int32> Ring;
+	GetVertexTriangles(A, Ring);
+	int32 Current = -1, CrossedEdge = -1;
+	for (int32 tid : Ring)
+	{
+		const int32 i = IndexOf(Triangles[tid], A);
+		const int32 V1 = Triangles[tid][(i + 1) % 3], V2 = Triangles[tid][(i + 2) % 3];
+		const double O1 = PointTriangleRelation::Orient2D(PA, PB, Vertices[V1]);
+		const double O2 = PointTriangleRelation::Orient2D(PA, PB, Vertices[V2]);
+		if (O1 == 0 && (Vertices[V1] - PA).Dot(Direction) > 0)
+		{
+			return InsertConstraintSegment(A, V1, Depth + 1) && InsertConstraintSegment(V1, B, Depth + 1);
+		}
+		if (O1 < 0 && O2 > 0)
+		{
+			Current = tid;
+			CrossedEdge = (i + 1) % 3;
+		}
+	}
+	if (Current < 0)
+	{
+		return false;
+	}
+
+	// walk to B and collect the crossed edges. Each crossed edge is stored with its right (of AB) vertex first
+	TArray<FIndex2i> Crossing;
+	while (true)
+	{
+		const int32 U = Triangles[Current][CrossedEdge], W = Triangles[Current][(CrossedEdge + 1) % 3];
+		if (IsConstrainedEdge(U, W))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FIncrementalDelaunay2: constraint %d-%d crosses an existing constraint and was not inserted"), A, B);
+			return false;
+		}
+		Crossing.Add(FIndex2i(U, W));
+
+		const int32 M = TriangleNeighbors[Current][CrossedEdge];
+		const int32 f = IndexOf(Triangles[M], W);
+		const int32 D = Triangles[M][(f + 2) % 3];
+		if (D == B)
+		{
+			break;
+		}
+		const double OD = PointTriangleRelation::Orient2D(PA, PB, Vertices[D]);
+		if (OD == 0)
+		{
+			return InsertConstraintSegment(A, D, Depth + 1) && InsertConstraintSegment(D, B, Depth + 1);
+		}
+		// M = (W,U,D): continue through (D,W) if D is right of AB, else through (U,D)
+		Current = M;
+		CrossedEdge = (OD < 0) ? (f + 2) % 3 : (f + 1) % 3;
+	}
+
+	// Flip the crossed edges until none is left (Sloan). An edge whose quad is not convex is retried later
+	TArray<FIndex2i> NewEdges;
+	int32 Head = 0;
+	const int32 MaxIterations = 64 + Crossing.Num() * Crossing.Num() * 4;
+	for (int32 Iteration = 0; Head < Crossing.Num(); ++Iteration)
+	{
+		if (Iteration > MaxIterations)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FIncrementalDelaunay2: failed to insert constraint %d-%d"), A, B);
+			return false;
+		}
+		const FIndex2i UW = Crossing[Head++];
+		const int32 T = FindEdge(UW.A, UW.B, Edge);
+		if (T < 0)
+		{
+			continue;
+		}
+		const int32 M = TriangleNeighbors[T][Edge];
+		const int32 P = Triangles[T][(Edge + 2) % 3];
+		const int32 D = Triangles[M][(IndexOf(Triangles[M], UW.B) + 2) % 3];
+		if (SegmentsCross(Vertices[P], Vertices[D], Vertices[UW.A], Vertices[UW.B]) == false)
+		{
+			Crossing.Add(UW);
+			continue;
+		}
+
+		FlipEdge(T, Edge);
+		if (P != A && P != B && D != A && D != B && SegmentsCross(Vertices[P], Vertices[D], PA, PB))
+		{
+			Crossing.Add(FIndex2i(P, D));
+		}
+		else
+		{
+			NewEdges.Add(FIndex2i(P, D));
+		}
+	}
+
+	ConstrainedEdges.FindOrAdd(EdgeKey(A, B), 0)++;
+
+	// restore the Delaunay property around the new edges
+	TArray<TPair<int32, int32>> EdgeStack;
+	for (const FIndex2i& NewEdge : NewEdges)
+	{
+		const int32 T = FindEdge(NewEdge.A, NewEdge.B, Edge);
+		if (T >= 0 && EdgeKey(NewEdge.A, NewEdge.B) != EdgeKey(A, B))
+		{
+			EdgeStack.Add(TPair<int32, int32>(T, Edge));
+		}
+	}
+	LegalizeEdges(EdgeStack);
+	return true;
+}
+
+
+bool FIncrementalDelaunay2::FindConstraintChain(int32 A, int32 B, TArray<FIndex2i>& EdgesOut) const
+{
+	using namespace IncrementalDelaunay2Local;
+
+	EdgesOut.Reset();
+	const FVector2f Direction = Vertices[B] - Vertices[A];
+	int32 Current = A;
+	TArray<int32> Ring;
+	while (Current != B && EdgesOut.Num() < VertexRefCounts.Num())
+	{
+		GetVertexTriangles(Current, Ring);
+		int32 Next = -1;
+		for (int32 tid : Ring)
+		{
+			const int32 V = Triangles[tid][(IndexOf(Triangles[tid], Current) + 1) % 3];
+			if (IsConstrainedEdge(Current, V)
+				&& (V == B || PointTriangleRelation::Orient2D(Vertices[A], Vertices[B], Vertices[V]) == 0)
+				&& (Vertices[V] - Vertices[Current]).Dot(Direction) > 0)
+			{
+				Next = V;
+				break;
+			}
+		}
+		if (Next < 0)
+		{
+			return false;
+		}
+		EdgesOut.Add(FIndex2i(Current, Next));
+		Current = Next;
+	}
+	return Current == B;
+}
+
+
+bool FIncrementalDelaunay2::RemoveConstraint(int32 VertexA, int32 VertexB)
+{
+	if (IsVertex(VertexA) == false || IsVertex(VertexB) == false)
+	{
+		return false;
+	}
+
+	TArray<FIndex2i> Chain;
+	if (FindConstraintChain(VertexA, VertexB, Chain) == false)
+	{
+		return false;
+	}
+
+	TArray<TPair<int32, int32>> EdgeStack;
+	for (const FIndex2i& ChainEdge : Chain)
+	{
+		int32& Count = ConstrainedEdges[EdgeKey(ChainEdge.A, ChainEdge.B)];
+		if (--Count == 0)
+		{
+			ConstrainedEdges.Remove(EdgeKey(ChainEdge.A, ChainEdge.B));
+			int32 Edge;
+			const int32 T = FindEdge(ChainEdge.A, ChainEdge.B, Edge);
+			if (T >= 0)
+			{
+				EdgeStack.Add(TPair<int32, int32>(T, Edge));
+			}
+		}
+	}
+	LegalizeEdges(EdgeStack);
+	return true;
+}
+
+
+void FIncrementalDelaunay2::UpdateOutputTriangles(TArray<int32>& ChangedTrianglesOut)
+{
+	const int32 NumTriangles = Triangles.Num();
+	const bool bUseParity = bFillByParity && ConstrainedEdges.Num() > 0;
+
+	// Nesting depth of each triangle: the number of constraint edges crossed from the super triangle (0-1 BFS)
+	TArray<int32> Depth;
+	if (bUseParity)
+	{
+		Depth.Init(MAX_int32, NumTriangles);
+		TArray<int32> Queue;
+		Queue.Reserve(NumTriangles);
+		TArray<int32> NextQueue;
+		for (int32 tid = 0; tid < NumTriangles; ++tid)
+		{
+			const FIndex3i& Tri = Triangles[tid];
+			if (TriangleAlive[tid] && (Tri.A < NumSuperVertices || Tri.B < NumSuperVertices || Tri.C < NumSuperVertices))
+			{
+				Depth[tid] = 0;
+				Queue.Add(tid);
+			}
+		}
+		for (int32 CurrentDepth = 0; Queue.Num() > 0; ++CurrentDepth)
+		{
+			NextQueue.Reset();
+			for (int32 Head = 0; Head < Queue.Num(); ++Head)
+			{
+				const int32 tid = Queue[Head];
+				if (Depth[tid] != CurrentDepth)
+				{
+					continue;
+				}
+				for (int32 e = 0; e < 3; ++e)
+				{
+					const int32 Nbr = TriangleNeighbors[tid][e];
+					if (Nbr < 0)
+					{
+						continue;
+					}
+					const bool bConstrained = IsConstrainedEdge(Triangles[tid][e], Triangles[tid][(e + 1) % 3]);
+					const int32 NbrDepth = CurrentDepth + (bConstrained ? 1 : 0);
+					if (NbrDepth < Depth[Nbr])
+					{
+						Depth[Nbr] = NbrDepth;
+						(bConstrained ? NextQueue : Queue).Add(Nbr);
+					}
+				}
+			}
+			Swap(Queue, NextQueue);
+		}
+	}
+
+	// after Reset() there can be fewer triangles than previously output ones
+	const int32 NumOutput = FMath::Max(NumTriangles, TriangleOutput.Num());
+	TArray<bool> bChanged;
+	bChanged.Init(false, NumOutput);
+	for (int32 tid : ChangedTriangles)
+	{
+		bChanged[tid] = true;
+	}
+	ChangedTriangles.Reset();
+
+	TriangleOutput.SetNum(NumOutput);
+	ChangedTrianglesOut.Reset();
+	for (int32 tid = 0; tid < NumOutput; ++tid)
+	{
+		const FIndex3i Tri = (tid < NumTriangles) ? Triangles[tid] : FIndex3i(-1, -1, -1);
+		bool bOutput = IsTriangle(tid) && Tri.A >= NumSuperVertices && Tri.B >= NumSuperVertices && Tri.C >= NumSuperVertices;
+		if (bOutput && bUseParity)
+		{
+			bOutput = (Depth[tid] % 2) == 1;
+		}
+		if (bChanged[tid] || bOutput != TriangleOutput[tid])
+		{
+			ChangedTrianglesOut.Add(tid);
+		}
+		TriangleOutput[tid] = bOutput;
+	}
+}
@@ -2,18 +2,105 @@
 
 
 #include "../Public/Algorithms/PointTriangleRelation.h"
+#include "CompGeom/ExactPredicates.h"
+
+namespace PointTriangleRelationLocal
+{
+	// Shewchuk's ccwerrboundA: if |det| exceeds this times the sum of the magnitudes of the two products, the double sign is correct
+	static constexpr double Orient2DErrorBound = (3.0 + 16.0 * DBL_EPSILON * 0.5) * DBL_EPSILON * 0.5;
+
+	static double ExactOrient2D(const FVector2f& A, const FVector2f& B, const FVector2f& C)
+	{
+		double PA[2] = { A.X, A.Y }, PB[2] = { B.X, B.Y }, PC[2] = { C.X, C.Y };
+		return UE::Geometry::ExactPredicates::Orient2D(PA, PB, PC);
+	}
+
+	// classify from the orientations of (A,B,P), (B,C,P), (C,A,P), already multiplied by the triangle orientation sign
+	static EPointTriangleLocation ClassifyOrientations(double O0, double O1, double O2, int32& EdgeOrVertexOut)
+	{
+		EdgeOrVertexOut = -1;
+		if (O0 < 0 || O1 < 0 || O2 < 0)
+		{
+			return EPointTriangleLocation::Outside;
+		}
+		const int32 NumZero = (O0 == 0) + (O1 == 0) + (O2 == 0);
+		if (NumZero == 0)
+		{
+			return EPointTriangleLocation::Inside;
+		}
+		if (NumZero == 1)
+		{
+			EdgeOrVertexOut = (O0 == 0) ? 0 : (O1 == 0) ? 1 : 2;
+			return EPointTriangleLocation::OnEdge;
+		}
+		if (NumZero == 2)
+		{
+			// the shared vertex of the two zero edges, edge e ends at vertex (e+1)%3
+			EdgeOrVertexOut = (O0 != 0) ? 2 : (O1 != 0) ? 0 : 1;
+			return EPointTriangleLocation::OnVertex;
+		}
+		return EPointTriangleLocation::Outside;
+	}
+}
+
+
+bool PointTriangleRelation::IsPointInTriangle2D(const FVector2f& TestPoint, const FVector2f& PointA, const FVector2f& PointB, const FVector2f& PointC)
+{
+	int32 EdgeOrVertex;
+	return ClassifyPointInTriangle2D(TestPoint, PointA, PointB, PointC, EdgeOrVertex) == EPointTriangleLocation::Inside;
+}
+
+
+double PointTriangleRelation::Orient2D(const FVector2f& A, const FVector2f& B, const FVector2f& C)
+{
+	using namespace PointTriangleRelationLocal;
+
+	const double DetLeft = ((double)A.X - C.X) * ((double)B.Y - C.Y);
+	const double DetRight = ((double)A.Y - C.Y) * ((double)B.X - C.X);
+	const double Det = DetLeft - DetRight;
+	if (FMath::Abs(Det) >= Orient2DErrorBound * (FMath::Abs(DetLeft) + FMath::Abs(DetRight)))
+	{
+		return Det;
+	}
+	return ExactOrient2D(A, B, C);
+}
+
+
+double PointTriangleRelation::InCircle2D(const FVector2f& A, const FVector2f& B, const FVector2f& C, const FVector2f& P)
+{
+	double PA[2] = { A.X, A.Y }, PB[2] = { B.X, B.Y }, PC[2] = { C.X, C.Y }, PP[2] = { P.X, P.Y };
+	return UE::Geometry::ExactPredicates::InCircle(PA, PB, PC, PP);
+}
+
+
+EPointTriangleLocation PointTriangleRelation::ClassifyPointInTriangle2D(const FVector2f& TestPoint, const FVector2f& PointA, const FVector2f& PointB, const FVector2f& PointC, int32& EdgeOrVertexOut)
+{
+	const double TriangleOrient = Orient2D(PointA, PointB, PointC);
+	if (TriangleOrient == 0)
+	{
+		EdgeOrVertexOut = -1;
+		return EPointTriangleLocation::Outside;
+	}
+	const double Sign = (TriangleOrient > 0) ? 1.0 : -1.0;
+	return PointTriangleRelationLocal::ClassifyOrientations(
+		Sign * Orient2D(PointA, PointB, TestPoint),
+		Sign * Orient2D(PointB, PointC, TestPoint),
+		Sign * Orient2D(PointC, PointA, TestPoint), EdgeOrVertexOut);
+}
 
 
-bool PointTriangleRelation::IsPointInTriangle2D(FVector2f& TestPoint, FVector2f& PointA,  FVector2f& PointB, FVector2f& PointC)
+int32 PointTriangleRelation::FindTriangleContainingPoint2D(const FVector2f& TestPoint, TArrayView<const FVector2f> Vertices, TArrayView<const UE::Geometry::FIndex3i> Triangles, EPointTriangleLocation& LocationOut, int32& EdgeOrVertexOut)
 {
-	float a = ((TestPoint.X - PointB.X) * (PointC.Y - PointB.Y) - (TestPoint.Y - PointB.Y) * (PointC.X - PointB.X)) /
-				((PointA.X - PointB.X) * (PointC.Y - PointB.Y) - (PointA.Y - PointB.Y) * (PointC.X - PointB.X));
-	float b = ((TestPoint.X - PointC.X) * (PointA.Y - PointC.Y) - (TestPoint.Y - PointC.Y) *( PointA.X - PointC.X)) /
-				((PointB.X - PointC.X) * (PointA.Y - PointC.Y) - (PointB.Y - PointC.Y)*(PointA.X - PointC.X));
-	float c = 1 - a - b;
-
-	if( a > 0 && a < 1 && b > 0 && b < 1 && c > 0 && c < 1)
-		return true;
-	
-	return false;
+	for (int32 t = 0; t < Triangles.Num(); ++t)
+	{
+		const UE::Geometry::FIndex3i& Tri = Triangles[t];
+		LocationOut = ClassifyPointInTriangle2D(TestPoint, Vertices[Tri.A], Vertices[Tri.B], Vertices[Tri.C], EdgeOrVertexOut);
+		if (LocationOut != EPointTriangleLocation::Outside)
+		{
+			return t;
+		}
+	}
+	LocationOut = EPointTriangleLocation::Outside;
+	EdgeOrVertexOut = -1;
+	return -1;
 }
@@ -0,0 +1,116 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../../Public/Algorithms/ProbeField.h"
+
+using namespace UE::Geometry;
+
+
+void FProbeField::Build(TArrayView<const FVector3d> InPositions, TArrayView<const double> InValues, double InCutoffRadius)
+{
+	const int32 NumProbes = InPositions.Num();
+	CutoffRadius = FMath::Max(InCutoffRadius, UE_DOUBLE_KINDA_SMALL_NUMBER);
+	Positions.Reset();
+	Values.Reset();
+	ProbeIndices.Reset();
+	CellStarts.Reset();
+	Bounds = FAxisAlignedBox3d::Empty();
+	MaxValue = 0;
+	if (NumProbes == 0)
+	{
+		Dimensions = FIntVector::ZeroValue;
+		return;
+	}
+
+	for (const FVector3d& Position : InPositions)
+	{
+		Bounds.Contain(Position);
+	}
+
+	// cells no smaller than the cutoff radius, so a query visits at most 3x3x3 cells
+	CellSize = CutoffRadius;
+	auto CellsAlong = [this](double Extent) { return (int64)(Extent / CellSize) + 1; };
+	while (CellsAlong(Bounds.Width()) * CellsAlong(Bounds.Height()) * CellsAlong(Bounds.Depth()) > MaxCells)
+	{
+		CellSize *= 2;
+	}
+	Dimensions = FIntVector((int32)CellsAlong(Bounds.Width()), (int32)CellsAlong(Bounds.Height()), (int32)CellsAlong(Bounds.Depth()));
+
+	// counting sort of the probes by cell
+	const int32 NumCells = Dimensions.X * Dimensions.Y * Dimensions.Z;
+	TArray<int32> ProbeCells;
+	ProbeCells.SetNumUninitialized(NumProbes);
+	CellStarts.SetNumZeroed(NumCells + 1);
+	for (int32 i = 0; i < NumProbes; ++i)
+	{
+		const FIntVector Cell = GetCell(InPositions[i]);
+		ProbeCells[i] = (Cell.Z * Dimensions.Y + Cell.Y) * Dimensions.X + Cell.X;
+		CellStarts[ProbeCells[i] + 1]++;
+	}
+	for (int32 c = 0; c < NumCells; ++c)
+	{
+		CellStarts[c + 1] += CellStarts[c];
+	}
+
+	TArray<int32> CellFill(CellStarts.GetData(), NumCells);
+	Positions.SetNumUninitialized(NumProbes);
+	Values.SetNumUninitialized(NumProbes);
+	ProbeIndices.SetNumUninitialized(NumProbes);
+	for (int32 i = 0; i < NumProbes; ++i)
+	{
+		const int32 k = CellFill[ProbeCells[i]]++;
+		Positions[k] = InPositions[i];
+		Values[k] = InValues.IsValidIndex(i) ? InValues[i] : 1.0;
+		ProbeIndices[k] = i;
+		MaxValue = FMath::Max(MaxValue, Values[k]);
+	}
+}
+
+
+bool FProbeField::FindNearest(const FVector3d& Point, int32& ProbeIndexOut, double& DistanceOut) const
+{
+	double NearestDistSqr = TNumericLimits<double>::Max();
+	ProbeIndexOut = -1;
+	ForEachWithinCutoff(Point, [&](int32 ProbeIndex, const FVector3d&, double, double DistSqr)
+	{
+		if (DistSqr < NearestDistSqr)
+		{
+			NearestDistSqr = DistSqr;
+			ProbeIndexOut = ProbeIndex;
+		}
+	});
+	if (ProbeIndexOut < 0)
+	{
+		return false;
+	}
+	DistanceOut = FMath::Sqrt(NearestDistSqr);
+	return true;
+}
+
+
+double FProbeField::EvaluateMetaball(const FVector3d& Point) const
+{
+	const double InvCutoffSqr = 1.0 / (CutoffRadius * CutoffRadius);
+	double Sum = 0;
+	ForEachWithinCutoff(Point, [&](int32, const FVector3d&, double Value, double DistSqr)
+	{
+		const double t = 1.0 - DistSqr * InvCutoffSqr;
+		Sum += Value * t * t * t;
+	});
+	return Sum;
+}
+
+
+double FProbeField::EvaluateSmoothMin(const FVector3d& Point, double SphereRadius, double Blend) const
+{
+	// with no probe within the cutoff radius the distance is at least CutoffRadius - SphereRadius * MaxValue
+	double Distance = CutoffRadius - SphereRadius * MaxValue;
+	const double InvBlend = 1.0 / FMath::Max(Blend, UE_DOUBLE_KINDA_SMALL_NUMBER);
+	ForEachWithinCutoff(Point, [&](int32, const FVector3d&, double Value, double DistSqr)
+	{
+		const double SphereDistance = FMath::Sqrt(DistSqr) - SphereRadius * Value;
+		const double h = FMath::Max(Blend - FMath::Abs(Distance - SphereDistance), 0.0) * InvBlend;
+		Distance = FMath::Min(Distance, SphereDistance) - 0.25 * h * h * Blend;
+	});
+	return -Distance;
+}
@@ -1,11 +1,14 @@
 ﻿#include "DynamicFBXImporter.h"
 #include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "DynamicMesh/MeshNormals.h"
 #include "Components/DynamicMeshComponent.h"
 #include "ImportedFBXActor.h"
+#include "Async/ParallelFor.h"
+#include "DynamicMeshEditor.h"
+#include "DynamicMesh/MeshTransforms.h"
+#include "Hash/CityHash.h"
 
 
-UE_DISABLE_OPTIMIZATION
-
 using namespace UE::Geometry;
 
 
@@ -18,117 +21,379 @@ ADynamicFBXImporter::~ADynamicFBXImporter()
 {
 }
 
-void ADynamicFBXImporter::BuildMesh(FbxNode* node, UE::Geometry::FDynamicMesh3& MeshOut)
+namespace FBXImporterLocal
 {
-	FbxMesh* fbx_mesh = node->GetMesh();
-	fbxsdk::FbxVector4* vertices = fbx_mesh->GetControlPoints();
-	int numVertices = fbx_mesh->GetControlPointsCount();
+	/** Polygon and polygon-vertex indices of the corners of a fan-triangulated mesh triangle */
+	struct FFBXTriangle
+	{
+		int32 TriangleID;
+		int32 Polygon;
+		FIndex3i PolygonVertices;
+	};
+
+	/**
+	 * Index into the direct array of a layer element for one polygon corner, according to the element's mapping
+	 * mode (by control point, by polygon vertex, by polygon or all same) and reference mode (direct or index-to-direct).
+	 * @return -1 if the mode is not supported or the index is out of range
+	 */
+	template<typename FbxElementType>
+	static int32 GetDirectIndex(const FbxLayerElementTemplate<FbxElementType>* Element, int32 ControlPoint, int32 Polygon, int32 PolygonVertex)
+	{
+		int32 MappedIndex = -1;
+		switch (Element->GetMappingMode())
+		{
+		case FbxLayerElement::eByControlPoint:	MappedIndex = ControlPoint; break;
+		case FbxLayerElement::eByPolygonVertex:	MappedIndex = PolygonVertex; break;
+		case FbxLayerElement::eByPolygon:		MappedIndex = Polygon; break;
+		case FbxLayerElement::eAllSame:			MappedIndex = 0; break;
+		default:								return -1;
+		}
 
-	int numIndices = fbx_mesh->GetPolygonVertexCount();
-	int* indices = fbx_mesh->GetPolygonVertices();
+		int32 DirectIndex = -1;
+		switch (Element->GetReferenceMode())
+		{
+		case FbxLayerElement::eDirect:
+			DirectIndex = MappedIndex;
+			break;
+		case FbxLayerElement::eIndex:
+		case FbxLayerElement::eIndexToDirect:
+			DirectIndex = (MappedIndex >= 0 && MappedIndex < Element->GetIndexArray().GetCount()) ? Element->GetIndexArray().GetAt(MappedIndex) : -1;
+			break;
+		}
+		return (DirectIndex >= 0 && DirectIndex < Element->GetDirectArray().GetCount()) ? DirectIndex : -1;
+	}
 
-	fbxsdk::FbxLayerElementUV* pUVs = fbx_mesh->GetLayer(0)->GetUVs();
-	fbxsdk::FbxLayerElementArrayTemplate<fbxsdk::FbxVector2>* pUVArray = &pUVs->GetDirectArray();
+	/**
+	 * Set the overlay triangles from a layer element. One overlay element is created per (vertex, value) pair, so
+	 * corners that share a vertex and a value share an element (smooth) even if the file stores a value per corner
+	 * (eByPolygonVertex/eDirect), and corners with different values get split elements (hard edges, UV seams).
+	 * Triangles with an unmapped corner are left unset.
+	 */
+	template<typename OverlayType, typename FbxElementType, typename ConvertFunc>
+	static void BuildOverlay(const FDynamicMesh3& Mesh, const TArray<FFBXTriangle>& Triangles,
+		const FbxLayerElementTemplate<FbxElementType>* Element, OverlayType* Overlay, ConvertFunc Convert)
+	{
+		const FbxLayerElementArrayTemplate<FbxElementType>& DirectArray = Element->GetDirectArray();
 
-	fbxsdk::FbxGeometryElementNormal* pNormals = fbx_mesh->GetElementNormal();
-	fbxsdk::FbxLayerElementArrayTemplate<fbxsdk::FbxVector4>* pNormalArray = &pNormals->GetDirectArray();
+		// elements of each vertex, usually one or a few, so a linear search over their values
+		TArray<TArray<int32, TInlineAllocator<2>>> VertexElements;
+		VertexElements.SetNum(Mesh.MaxVertexID());
 
-	// Enable Attributes(Normals, UVs)
-	MeshOut.EnableAttributes();
+		for (const FFBXTriangle& Tri : Triangles)
+		{
+			FIndex3i Vertices = Mesh.GetTriangle(Tri.TriangleID);
+			FIndex3i Elements;
+			bool bValid = true;
+			for (int32 j = 0; j < 3 && bValid; ++j)
+			{
+				int32 DirectIndex = GetDirectIndex(Element, Vertices[j], Tri.Polygon, Tri.PolygonVertices[j]);
+				if (DirectIndex < 0)
+				{
+					bValid = false;
+					break;
+				}
+				const auto Value = Convert(DirectArray.GetAt(DirectIndex));
+				TArray<int32, TInlineAllocator<2>>& Candidates = VertexElements[Vertices[j]];
+				Elements[j] = -1;
+				for (int32 ElementID : Candidates)
+				{
+					if (Overlay->GetElement(ElementID) == Value)
+					{
+						Elements[j] = ElementID;
+						break;
+					}
+				}
+				if (Elements[j] < 0)
+				{
+					Elements[j] = Overlay->AppendElement(Value);
+					Candidates.Add(Elements[j]);
+				}
+			}
+			if (bValid)
+			{
+				Overlay->SetTriangle(Tri.TriangleID, Elements);
+			}
+		}
+	}
 
-	FDynamicMeshNormalOverlay* Normals = MeshOut.Attributes()->PrimaryNormals();
-	FDynamicMeshUVOverlay* UVs = MeshOut.Attributes()->PrimaryUV();
+	template<typename ValueType>
+	static uint64 HashLayerArray(const FbxLayerElementArrayTemplate<ValueType>& Array, uint64 Hash)
+	{
+		for (int32 i = 0; i < Array.GetCount(); ++i)
+		{
+			const ValueType Value = Array.GetAt(i);
+			Hash = CityHash64WithSeed((const char*)&Value, sizeof(ValueType), Hash);
+		}
+		return Hash + Array.GetCount();
+	}
 
-	// Iterate Vertices
-	for (size_t i = 0; i < numVertices; i++)
+	template<typename ValueType>
+	static bool IsSameLayerArray(const FbxLayerElementArrayTemplate<ValueType>& A, const FbxLayerElementArrayTemplate<ValueType>& B)
 	{
-		// Append Vertices
-		MeshOut.AppendVertex(FVector3d(vertices[i][0], vertices[i][1], vertices[i][2]));
+		if (A.GetCount() != B.GetCount())
+		{
+			return false;
+		}
+		for (int32 i = 0; i < A.GetCount(); ++i)
+		{
+			if (!(A.GetAt(i) == B.GetAt(i)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 
-		// Append Normals
-		fbxsdk::FbxVector4 normal = pNormalArray->GetAt(i);
-		Normals->AppendElement(FVector3f(normal[0], normal[1], normal[2]));
+	/**
+	 * Hash of the mapping, the index array and (if bDirectArray) the direct array of a layer element, which may be null.
+	 * The direct array of material elements holds no per-mesh data, only the index array is relevant there.
+	 */
+	template<typename FbxElementType>
+	static uint64 HashLayerElement(const FbxLayerElementTemplate<FbxElementType>* Element, bool bDirectArray, uint64 Hash)
+	{
+		const int32 Modes[2] = { Element ? (int32)Element->GetMappingMode() : -1, Element ? (int32)Element->GetReferenceMode() : -1 };
+		Hash = CityHash64WithSeed((const char*)Modes, sizeof(Modes), Hash);
+		if (Element == nullptr)
+		{
+			return Hash;
+		}
+		if (Element->GetReferenceMode() != FbxLayerElement::eDirect)
+		{
+			Hash = HashLayerArray(Element->GetIndexArray(), Hash);
+		}
+		return (bDirectArray) ? HashLayerArray(Element->GetDirectArray(), Hash) : Hash;
+	}
 
-		// Append UVs
-		fbxsdk::FbxVector2 uv = pUVArray->GetAt(i);
-		UVs->AppendElement(FVector2f(uv[0], uv[1]));
+	template<typename FbxElementType>
+	static bool IsSameLayerElement(const FbxLayerElementTemplate<FbxElementType>* A, const FbxLayerElementTemplate<FbxElementType>* B, bool bDirectArray)
+	{
+		if (A == nullptr || B == nullptr)
+		{
+			return A == B;
+		}
+		return A->GetMappingMode() == B->GetMappingMode()
+			&& A->GetReferenceMode() == B->GetReferenceMode()
+			&& (A->GetReferenceMode() == FbxLayerElement::eDirect || IsSameLayerArray(A->GetIndexArray(), B->GetIndexArray()))
+			&& (!bDirectArray || IsSameLayerArray(A->GetDirectArray(), B->GetDirectArray()));
 	}
 
-	// Append Indices
-	for (size_t i = 0; i < numIndices/3; i++)
+	/** Hash of everything BuildMesh() reads from Mesh: control points, polygons, and the first normal/UV/color/material layer */
+	static uint64 HashGeometry(FbxMesh* Mesh)
 	{
-		MeshOut.AppendTriangle(*(indices + (3 * i)), *(indices + (3 * i) + 1), *(indices + (3 * i) + 2));
+		uint64 Hash = CityHash64((const char*)Mesh->GetControlPoints(), (uint32)(Mesh->GetControlPointsCount() * sizeof(FbxVector4)));
+		Hash = CityHash64WithSeed((const char*)Mesh->GetPolygonVertices(), (uint32)(Mesh->GetPolygonVertexCount() * sizeof(int)), Hash + Mesh->GetPolygonCount());
+		for (int32 p = 0; p < Mesh->GetPolygonCount(); ++p)
+		{
+			const int32 PolygonSize = Mesh->GetPolygonSize(p);
+			Hash = CityHash64WithSeed((const char*)&PolygonSize, sizeof(PolygonSize), Hash);
+		}
+		Hash = HashLayerElement(Mesh->GetElementNormal(0), true, Hash);
+		Hash = HashLayerElement(Mesh->GetElementUV(0), true, Hash);
+		Hash = HashLayerElement(Mesh->GetElementVertexColor(0), true, Hash);
+		return HashLayerElement(Mesh->GetElementMaterial(0), false, Hash);
 	}
 
+	static bool IsSameGeometry(FbxMesh* A, FbxMesh* B)
+	{
+		if (A->GetControlPointsCount() != B->GetControlPointsCount()
+			|| A->GetPolygonCount() != B->GetPolygonCount()
+			|| A->GetPolygonVertexCount() != B->GetPolygonVertexCount()
+			|| FMemory::Memcmp(A->GetControlPoints(), B->GetControlPoints(), A->GetControlPointsCount() * sizeof(FbxVector4)) != 0
+			|| FMemory::Memcmp(A->GetPolygonVertices(), B->GetPolygonVertices(), A->GetPolygonVertexCount() * sizeof(int)) != 0)
+		{
+			return false;
+		}
+		for (int32 p = 0; p < A->GetPolygonCount(); ++p)
+		{
+			if (A->GetPolygonSize(p) != B->GetPolygonSize(p))
+			{
+				return false;
+			}
+		}
+		return IsSameLayerElement(A->GetElementNormal(0), B->GetElementNormal(0), true)
+			&& IsSameLayerElement(A->GetElementUV(0), B->GetElementUV(0), true)
+			&& IsSameLayerElement(A->GetElementVertexColor(0), B->GetElementVertexColor(0), true)
+			&& IsSameLayerElement(A->GetElementMaterial(0), B->GetElementMaterial(0), false);
+	}
 }
 
-void ADynamicFBXImporter::IterateNode(FbxNode* node)
+
+void ADynamicFBXImporter::BuildMesh(FbxMesh* fbx_mesh, UE::Geometry::FDynamicMesh3& MeshOut, bool bNormals, bool bTexCoords, bool bVertexColors, bool bReverseOrientation) const
 {
-	// Handle this node's attribute
-	FbxNodeAttribute* node_attribute = node->GetNodeAttribute();
+	using namespace FBXImporterLocal;
+
+	const fbxsdk::FbxVector4* vertices = fbx_mesh->GetControlPoints();
+	int numVertices = fbx_mesh->GetControlPointsCount();
+	const int* indices = fbx_mesh->GetPolygonVertices();
 
-	if (node_attribute)
+	// Append Vertices (control points)
+	for (int i = 0; i < numVertices; i++)
 	{
-		FbxNodeAttribute::EType type = node_attribute->GetAttributeType();
-		const char* nodeName = node->GetName();
-		FString str = UTF8_TO_TCHAR(nodeName);
+		MeshOut.AppendVertex(FVector3d(vertices[i][0], vertices[i][1], vertices[i][2]));
+	}
 
-		switch (type)
-		{
-		case FbxNodeAttribute::eMesh:
+	// Append Indices. Polygons are fan-triangulated here, so the scene does not need to be triangulated by the SDK first
+	TArray<FFBXTriangle> Triangles;
+	Triangles.Reserve(fbx_mesh->GetPolygonVertexCount());
+	int numPolygons = fbx_mesh->GetPolygonCount();
+	for (int p = 0; p < numPolygons; p++)
+	{
+		const int polygonStart = fbx_mesh->GetPolygonVertexIndex(p);
+		const int polygonSize = fbx_mesh->GetPolygonSize(p);
+		for (int v = 1; v < polygonSize - 1; v++)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[Mesh] %s"), *str);
+			FIndex3i Corners(polygonStart, polygonStart + v, polygonStart + v + 1);
+			int32 tid = MeshOut.AppendTriangle(indices[Corners.A], indices[Corners.B], indices[Corners.C]);
+			if (tid >= 0)
+			{
+				Triangles.Add({ tid, p, Corners });
+			}
+		}
+	}
 
-			FString ComponentName = FString::Printf(TEXT("%s"), *str);
+	// Normals/UVs/colors are read from the first layer, with the mapping of each element
+	const FbxGeometryElementNormal* pNormals = (bNormals) ? fbx_mesh->GetElementNormal(0) : nullptr;
+	const FbxGeometryElementUV* pUVs = (bTexCoords) ? fbx_mesh->GetElementUV(0) : nullptr;
+	const FbxGeometryElementVertexColor* pColors = (bVertexColors) ? fbx_mesh->GetElementVertexColor(0) : nullptr;
 
-			FDynamicMesh3 DynamicMesh;
-			BuildMesh(node, DynamicMesh);
-			SpawnedActor->AddMeshComponent(FName(*ComponentName),DynamicMesh);
+	if (bNormals || bTexCoords || pColors)
+	{
+		MeshOut.EnableAttributes();
+	}
 
-			break;
-		}
+	if (pNormals)
+	{
+		BuildOverlay(MeshOut, Triangles, pNormals, MeshOut.Attributes()->PrimaryNormals(),
+			[](const FbxVector4& Normal) { return FVector3f((float)Normal[0], (float)Normal[1], (float)Normal[2]); });
+	}
+	else if (bNormals)
+	{
+		// no normals in the file
+		FMeshNormals::InitializeOverlayToPerVertexNormals(MeshOut.Attributes()->PrimaryNormals(), false);
+	}
+
+	if (pUVs)
+	{
+		// FBX UVs have the origin at the bottom left, UE at the top left
+		BuildOverlay(MeshOut, Triangles, pUVs, MeshOut.Attributes()->PrimaryUV(),
+			[](const FbxVector2& UV) { return FVector2f((float)UV[0], 1.0f - (float)UV[1]); });
+	}
 
-		case FbxNodeAttribute::eNull:
+	if (pColors)
+	{
+		MeshOut.Attributes()->EnablePrimaryColors();
+		BuildOverlay(MeshOut, Triangles, pColors, MeshOut.Attributes()->PrimaryColors(),
+			[](const FbxColor& Color) { return FVector4f((float)Color.mRed, (float)Color.mGreen, (float)Color.mBlue, (float)Color.mAlpha); });
+	}
+
+	if (bReverseOrientation)
+	{
+		MeshOut.ReverseOrientation();
+	}
+}
+
+FTransform ADynamicFBXImporter::GetNodeMeshTransform(FbxNode* node)
+{
+	// the mesh is placed by the node global transform and the node geometric (pivot) offset, which is not inherited by children
+	FbxAMatrix GeometryOffset(
+		node->GetGeometricTranslation(FbxNode::eSourcePivot),
+		node->GetGeometricRotation(FbxNode::eSourcePivot),
+		node->GetGeometricScaling(FbxNode::eSourcePivot));
+	FbxAMatrix Matrix = node->EvaluateGlobalTransform() * GeometryOffset;
+
+	// FbxAMatrix uses the same row-vector convention as FMatrix
+	FMatrix UEMatrix;
+	for (int32 r = 0; r < 4; ++r)
+	{
+		for (int32 c = 0; c < 4; ++c)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[Null] %s"), *str);
-			break;
+			UEMatrix.M[r][c] = Matrix.Get(r, c);
 		}
+	}
+	return FTransform(UEMatrix);
+}
+
 
-		case FbxNodeAttribute::eUnknown:
+void ADynamicFBXImporter::GroupNodesByGeometry(const TArray<FbxNode*>& MeshNodes, TArray<FImportedGeometry>& GeometriesOut) const
+{
+	// nodes referencing the same FbxMesh share its geometry
+	TMap<FbxMesh*, int32> MeshToGeometry;
+	for (int32 k = 0; k < MeshNodes.Num(); ++k)
+	{
+		FbxMesh* Mesh = MeshNodes[k]->GetMesh();
+		int32* Found = MeshToGeometry.Find(Mesh);
+		if (Found == nullptr)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[Unknown] %s"), *str);
-			break;
+			FImportedGeometry& NewGeometry = GeometriesOut.AddDefaulted_GetRef();
+			NewGeometry.Mesh = Mesh;
+			Found = &MeshToGeometry.Add(Mesh, GeometriesOut.Num() - 1);
 		}
+		GeometriesOut[*Found].NodeIndices.Add(k);
+	}
 
-		default:
+	if (!bInstanceRepeatedMeshes)
+	{
+		return;
+	}
+
+	// different FbxMesh objects with identical control points, polygons and normals/UVs/colors/material indices
+	// (eg copies exported from CAD tools) are also shared
+	using namespace FBXImporterLocal;
+	TArray<uint64> Hashes;
+	Hashes.SetNum(GeometriesOut.Num());
+	ParallelFor(GeometriesOut.Num(), [&](int32 k)
+	{
+		Hashes[k] = HashGeometry(GeometriesOut[k].Mesh);
+	});
+
+	TMultiMap<uint64, int32> HashToGeometry;
+	TArray<FImportedGeometry> UniqueGeometries;
+	for (int32 k = 0; k < GeometriesOut.Num(); ++k)
+	{
+		TArray<int32, TInlineAllocator<4>> Candidates;
+		HashToGeometry.MultiFind(Hashes[k], Candidates);
+		int32* Match = Candidates.FindByPredicate([&](int32 Unique) { return IsSameGeometry(UniqueGeometries[Unique].Mesh, GeometriesOut[k].Mesh); });
+		if (Match)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("[Other] %s"), *str);
-			break;
+			UniqueGeometries[*Match].NodeIndices.Append(GeometriesOut[k].NodeIndices);
 		}
+		else
+		{
+			HashToGeometry.Add(Hashes[k], UniqueGeometries.Add(MoveTemp(GeometriesOut[k])));
 		}
-
 	}
+	GeometriesOut = MoveTemp(UniqueGeometries);
+}
 
 
+void ADynamicFBXImporter::CollectMeshNodes(FbxNode* node, TArray<FbxNode*>& MeshNodesOut)
+{
+	FbxNodeAttribute* node_attribute = node->GetNodeAttribute();
+	if (node_attribute && node_attribute->GetAttributeType() == FbxNodeAttribute::eMesh && node->GetMesh() != nullptr)
+	{
+		MeshNodesOut.Add(node);
+	}
+
 	// Iterate over children
 	int count = node->GetChildCount();
 	for (int i = 0; i < count; i++)
 	{
-		IterateNode(node->GetChild(i));
+		CollectMeshNodes(node->GetChild(i), MeshNodesOut);
 	}
 }
 
 
 
 bool ADynamicFBXImporter::ReadFBXMesh(const FString& Path,bool bNormals, bool bTexCoords, bool bVertexColors, bool bReverseOrientation)
-{	
+{
+	auto Start = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
 	// Create SDK Manager
 	SdkManager = FbxManager::Create();
 
 	// Create IO Settings
 	ios = FbxIOSettings::Create(SdkManager, IOSROOT);
 
-	ios->SetBoolProp(IMP_FBX_MATERIAL, true);
 	ios->SetBoolProp(IMP_FBX_MATERIAL, true);
 	ios->SetBoolProp(IMP_FBX_TEXTURE, true);
 	ios->SetBoolProp(IMP_FBX_LINK, false);
@@ -142,44 +407,140 @@ bool ADynamicFBXImporter::ReadFBXMesh(const FString& Path,bool bNormals, bool bT
 	// Create Importer
 	importer = FbxImporter::Create(SdkManager, "");
 
-	// Spawn an Actor
-	SpawnedActor = GetWorld()->SpawnActor<AImportedFBXActor>();
+	// Create a scene
+	FbxScene* Scene = FbxScene::Create(SdkManager, "Scene");
 
+	auto DestroySDKObjects = [this, &Scene]()
+	{
+		importer->Destroy();
+		importer = nullptr;
+		Scene->Destroy();
+		Scene = nullptr;
+		SdkManager->Destroy();
+		SdkManager = nullptr;
+		ios = nullptr;
+	};
+
+	// Initialize importer and import into the scene
+	FTCHARToUTF8 fileToImport(*Path);
+	if (!importer->Initialize(fileToImport.Get(), -1, SdkManager->GetIOSettings()) || !importer->Import(Scene))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error reading FBX file %s: %hs"), *Path, importer->GetStatus().GetErrorString());
+		DestroySDKObjects();
+		return false;
+	}
 
-	const char* fileToImport = "C:/Users/Ken/Desktop/701demo.fbx";
+	auto Imported = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
 
-	// Initialize importer
-	const bool initStatus = importer->Initialize(fileToImport,-1,SdkManager->GetIOSettings());
-	
-	// Create a scene
-	FbxScene* Scene = FbxScene::Create(SdkManager, "Scene");
+	// Collect the mesh nodes and their transforms
+	TArray<FbxNode*> MeshNodes;
+	CollectMeshNodes(Scene->GetRootNode(), MeshNodes);
 
-	// Import into the scene
-	const bool importStatus = importer->Import(Scene);
+	TArray<FTransform> NodeTransforms;
+	for (FbxNode* Node : MeshNodes)
+	{
+		NodeTransforms.Add(GetNodeMeshTransform(Node));
+	}
 
-	// Triangulate Mesh
-	FbxGeometryConverter converter(SdkManager);
-	converter.Triangulate(Scene, true);
+	// Group the nodes by geometry, each unique geometry is converted once
+	TArray<FImportedGeometry> Geometries;
+	GroupNodesByGeometry(MeshNodes, Geometries);
 
-	// Get Root Node
-	FbxNode* rootNode = Scene->GetRootNode();
+	auto Collected = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
 
-	// Iterate node
-	IterateNode(rootNode);
+	// Convert the meshes in parallel. BuildMesh only reads from the FBX scene
+	ParallelFor(Geometries.Num(), [&](int32 k)
+	{
+		BuildMesh(Geometries[k].Mesh, Geometries[k].DynamicMesh, bNormals, bTexCoords, bVertexColors, bReverseOrientation);
+	});
 
+	auto Converted = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
 
+	// Decide how each geometry is emitted: instanced, merged into a per-material batch, or one component per node
+	TArray<int32> InstancedGeometries;
+	TArray<TPair<int32, int32>> SingleNodes;		// (geometry, node)
+	TMap<FString, TArray<TPair<int32, int32>>> MergeGroups;
+	for (int32 gi = 0; gi < Geometries.Num(); ++gi)
+	{
+		const FImportedGeometry& Geometry = Geometries[gi];
+		if (bInstanceRepeatedMeshes && Geometry.NodeIndices.Num() >= FMath::Max(MinInstanceCount, 2))
+		{
+			InstancedGeometries.Add(gi);
+			continue;
+		}
+		for (int32 NodeIndex : Geometry.NodeIndices)
+		{
+			if (bMergeSmallNodes && Geometry.DynamicMesh.TriangleCount() < MergeTriangleThreshold)
+			{
+				FbxSurfaceMaterial* Material = (MeshNodes[NodeIndex]->GetMaterialCount() > 0) ? MeshNodes[NodeIndex]->GetMaterial(0) : nullptr;
+				FString MaterialName = (Material) ? UTF8_TO_TCHAR(Material->GetName()) : TEXT("None");
+				MergeGroups.FindOrAdd(MaterialName).Add(TPair<int32, int32>(gi, NodeIndex));
+			}
+			else
+			{
+				SingleNodes.Add(TPair<int32, int32>(gi, NodeIndex));
+			}
+		}
+	}
 
-	// Destroy 
-	importer->Destroy();
-	importer = nullptr;
-	Scene->Destroy();
-	Scene = nullptr;
-	SdkManager->Destroy();
-	SdkManager = nullptr;
+	// Build the merged meshes in parallel, in actor space
+	TArray<FString> MergeGroupNames;
+	MergeGroups.GetKeys(MergeGroupNames);
+	TArray<FDynamicMesh3> MergedMeshes;
+	MergedMeshes.SetNum(MergeGroupNames.Num());
+	ParallelFor(MergeGroupNames.Num(), [&](int32 k)
+	{
+		FDynamicMesh3& MergedMesh = MergedMeshes[k];
+		FDynamicMeshEditor Editor(&MergedMesh);
+		for (const TPair<int32, int32>& GeometryNode : MergeGroups[MergeGroupNames[k]])
+		{
+			FDynamicMesh3 NodeMesh = Geometries[GeometryNode.Key].DynamicMesh;
+			MeshTransforms::ApplyTransform(NodeMesh, (FTransformSRT3d)NodeTransforms[GeometryNode.Value], true);
+			if (NodeMesh.HasAttributes())
+			{
+				MergedMesh.EnableAttributes();
+				if (NodeMesh.Attributes()->HasPrimaryColors())
+				{
+					MergedMesh.Attributes()->EnablePrimaryColors();
+				}
+			}
+			FMeshIndexMappings Mappings;
+			Editor.AppendMesh(&NodeMesh, Mappings);
+		}
+	});
 
-	return true;
-}
+	auto Merged = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	// Create the components on the game thread
+	SpawnedActor = GetWorld()->SpawnActor<AImportedFBXActor>();
+	for (int32 gi : InstancedGeometries)
+	{
+		FImportedGeometry& Geometry = Geometries[gi];
+		TArray<FTransform> InstanceTransforms;
+		for (int32 NodeIndex : Geometry.NodeIndices)
+		{
+			InstanceTransforms.Add(NodeTransforms[NodeIndex]);
+		}
+		FString ComponentName = UTF8_TO_TCHAR(MeshNodes[Geometry.NodeIndices[0]]->GetName());
+		SpawnedActor->AddInstancedMeshComponent(FName(*ComponentName), Geometry.DynamicMesh, InstanceTransforms);
+	}
+	for (const TPair<int32, int32>& GeometryNode : SingleNodes)
+	{
+		FString ComponentName = UTF8_TO_TCHAR(MeshNodes[GeometryNode.Value]->GetName());
+		SpawnedActor->AddMeshComponent(FName(*ComponentName), Geometries[GeometryNode.Key].DynamicMesh, NodeTransforms[GeometryNode.Value]);
+	}
+	for (int32 k = 0; k < MergeGroupNames.Num(); ++k)
+	{
+		SpawnedActor->AddMeshComponent(FName(*(TEXT("Merged_") + MergeGroupNames[k])), MergedMeshes[k]);
+	}
+
+	auto End = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
 
+	DestroySDKObjects();
 
+	UE_LOG(LogTemp, Display, TEXT("ReadFBXMesh %s: %d mesh nodes, %d unique meshes, %d instanced, %d single, %d merged groups. Import: %f ms, Collect nodes: %f ms, Convert meshes: %f ms, Merge meshes: %f ms, Create components: %f ms, Total: %f ms"),
+		*Path, MeshNodes.Num(), Geometries.Num(), InstancedGeometries.Num(), SingleNodes.Num(), MergeGroupNames.Num(),
+		Imported - Start, Collected - Imported, Converted - Collected, Merged - Converted, End - Merged, End - Start);
 
-UE_ENABLE_OPTIMIZATION
\ No newline at end of file
+	return true;
+}
@@ -0,0 +1,89 @@
+#include "DynamicMeshAttributeUtils.h"
+
+using namespace UE::Geometry;
+
+namespace DynamicMeshAttributeUtilsLocal
+{
+	template<typename OverlayType>
+	static int64 EstimateOverlayByteCount(const OverlayType* Overlay, int32 MaxTriangleID, int32 ElementSize)
+	{
+		if (Overlay == nullptr)
+		{
+			return 0;
+		}
+		// element values + element refcounts + parent vertex per element, plus element triplet per triangle
+		return (int64)Overlay->MaxElementID() * (ElementSize + sizeof(uint16) + sizeof(int32))
+			+ (int64)MaxTriangleID * sizeof(FIndex3i);
+	}
+}
+
+
+int64 RTGUtils::GetAttachedAttributeByteCounts(
+	const FDynamicMesh3& Mesh,
+	TMap<FName, int64>& AttributeBytes)
+{
+	AttributeBytes.Reset();
+	if (Mesh.HasAttributes() == false)
+	{
+		return 0;
+	}
+
+	int64 TotalBytes = 0;
+	for (const TPair<FName, TUniquePtr<FDynamicMeshAttributeBase>>& AttribPair : Mesh.Attributes()->GetAttachedAttributes())
+	{
+		int64 Bytes = (AttribPair.Value.IsValid()) ? (int64)AttribPair.Value->GetByteCount() : 0;
+		AttributeBytes.Add(AttribPair.Key, Bytes);
+		TotalBytes += Bytes;
+	}
+	return TotalBytes;
+}
+
+
+int64 RTGUtils::EstimateMeshByteCount(const FDynamicMesh3& Mesh)
+{
+	using namespace DynamicMeshAttributeUtilsLocal;
+
+	const int32 MaxVID = Mesh.MaxVertexID();
+	const int32 MaxTID = Mesh.MaxTriangleID();
+	const int32 MaxEID = Mesh.MaxEdgeID();
+
+	// position + refcount + vertex-edge list entries (two per edge)
+	int64 Bytes = (int64)MaxVID * (sizeof(FVector3d) + sizeof(uint16)) + (int64)MaxEID * 2 * sizeof(int32);
+	Bytes += (Mesh.HasVertexNormals()) ? (int64)MaxVID * sizeof(FVector3f) : 0;
+	Bytes += (Mesh.HasVertexColors()) ? (int64)MaxVID * sizeof(FVector3f) : 0;
+	Bytes += (Mesh.HasVertexUVs()) ? (int64)MaxVID * sizeof(FVector2f) : 0;
+
+	// triangle vertices + triangle edges + refcount + group
+	Bytes += (int64)MaxTID * (2 * sizeof(FIndex3i) + sizeof(uint16));
+	Bytes += (Mesh.HasTriangleGroups()) ? (int64)MaxTID * sizeof(int32) : 0;
+
+	// edge vertices/triangles + refcount
+	Bytes += (int64)MaxEID * (2 * sizeof(FIndex2i) + sizeof(uint16));
+
+	if (Mesh.HasAttributes())
+	{
+		const FDynamicMeshAttributeSet* Attributes = Mesh.Attributes();
+		for (int32 k = 0; k < Attributes->NumUVLayers(); ++k)
+		{
+			Bytes += EstimateOverlayByteCount(Attributes->GetUVLayer(k), MaxTID, sizeof(FVector2f));
+		}
+		for (int32 k = 0; k < Attributes->NumNormalLayers(); ++k)
+		{
+			Bytes += EstimateOverlayByteCount(Attributes->GetNormalLayer(k), MaxTID, sizeof(FVector3f));
+		}
+		if (Attributes->HasPrimaryColors())
+		{
+			Bytes += EstimateOverlayByteCount(Attributes->PrimaryColors(), MaxTID, sizeof(FVector4f));
+		}
+		if (Attributes->HasMaterialID())
+		{
+			Bytes += (int64)MaxTID * sizeof(int32);
+		}
+		Bytes += (int64)Attributes->NumPolygroupLayers() * MaxTID * sizeof(int32);
+
+		TMap<FName, int64> AttributeBytes;
+		Bytes += GetAttachedAttributeByteCounts(Mesh, AttributeBytes);
+	}
+
+	return Bytes;
+}
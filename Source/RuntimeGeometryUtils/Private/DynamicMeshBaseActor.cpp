@@ -9,11 +9,15 @@
 #include "DynamicMesh/MeshTransforms.h"
 #include "MeshSimplification.h"
 #include "Operations/MeshBoolean.h"
+#include "Spatial/PointHashGrid3.h"
+#include "DynamicSubmesh3.h"
 #include "Implicit/Solidify.h"
 #include "Implicit/Morphology.h"
 
 
 #include "DynamicMeshOBJReader.h"
+#include "DynamicMeshBinaryCache.h"
+#include "MeshImportCacheSubsystem.h"
 #include "MeshDescriptionToDynamicMesh.h"
 #include "DynamicMeshToMeshDescription.h"
 #include "StaticMeshAttributes.h"
@@ -26,20 +30,26 @@
 
 #include "CleaningOps/HoleFillOp.h"
 #include "MeshBoundaryLoops.h"
+#include "MeshRepairUtils.h"
 
 #include "DynamicMeshOBJWriter.h"
+#include "DynamicMeshGLBWriter.h"
 #include "DynamicFBXImporter.h"
 #include "MeshOpPreviewHelpers.h"
 #include "../Public/Generators/ConvexHullGenerator.h"
 #include "../Public/Generators/RandomPointsMeshGenerator.h"
-#include "../Public/Generators/FDelaunayGenrator.h"
+#include "../Public/Generators/IncrementalDelaunayGenerator.h"
+#include "../Public/Algorithms/ProbeField.h"
+#include "../Public/Generators/TiledMarchingCubesGenerator.h"
 #include "CuttingOps/PlaneCutOp.h"
 #include "Operations/MeshPlaneCut.h"
 #include "DynamicMeshEditor.h"
 #include "DynamicMesh/DynamicMeshAttributeSet.h"
 #include "DynamicMesh/DynamicVertexSkinWeightsAttribute.h"
 #include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
 #include "MeshComponentRuntimeUtils.h"
+#include "DynamicMeshAttributeUtils.h"
 #include "Probe.h"
 
 
@@ -109,6 +119,7 @@ void ADynamicMeshBaseActor::PostEditChangeProperty(FPropertyChangedEvent& Proper
 void ADynamicMeshBaseActor::EditMesh(TFunctionRef<void(FDynamicMesh3&)> EditFunc)
 {
 	EditFunc(SourceMesh);
+	MeshRevision++;
 
 	// update spatial data structures
 	if (bEnableSpatialQueries || bEnableInsideQueries)
@@ -134,6 +145,11 @@ const FDynamicMesh3& ADynamicMeshBaseActor::GetMeshRef() const
 	return SourceMesh;
 }
 
+uint64 ADynamicMeshBaseActor::GetMeshRevision() const
+{
+	return MeshRevision;
+}
+
 void ADynamicMeshBaseActor::ForceRegenerate()
 {
 	OnMeshGenerationSettingsModified();
@@ -164,22 +180,11 @@ void ADynamicMeshBaseActor::RegenerateSourceMesh(FDynamicMesh3& MeshOut)
 			+ (this->VariableRadius) * FMathd::Sin(PulseSpeed * AccumulatedTime);
 
 		// generate new mesh
-		if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::Sphere)
-		{
-			FSphereGenerator SphereGen;
-			SphereGen.NumPhi = SphereGen.NumTheta = FMath::Clamp(this->TessellationLevel, 3, 50);
-			SphereGen.Radius = UseRadius;
-			MeshOut.Copy(&SphereGen.Generate());
-		}
-		else if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::Box)
+		if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::Sphere || this->PrimitiveType == EDynamicMeshActorPrimitiveType::Box)
 		{
-			FGridBoxMeshGenerator BoxGen;
-			int TessLevel = FMath::Clamp(this->TessellationLevel, 2, 50);
-			BoxGen.EdgeVertices = FIndex3i(TessLevel, TessLevel, TessLevel);
-			FVector3d BoxExtents = UseRadius * FVector3d::One();
-			BoxExtents.Z *= BoxDepthRatio;
-			BoxGen.Box = FOrientedBox3d(FVector3d::Zero(), BoxExtents);
-			MeshOut.Copy(&BoxGen.Generate());
+			// the cached unit mesh already has its normals
+			GetScaledPrimitiveMesh(MeshOut, UseRadius);
+			return;
 		}
 		else if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::ConvexHull)
 		{
@@ -187,6 +192,7 @@ void ADynamicMeshBaseActor::RegenerateSourceMesh(FDynamicMesh3& MeshOut)
 				return;
 			FConvexHullGenerator ConvexHullGenerator;
 			ConvexHullGenerator.InputVertices = RandomPoints;
+			ConvexHullGenerator.ExtrusionDepth = ExtrusionDepth;
 			MeshOut.Copy(&ConvexHullGenerator.Generate());
 		}
 		else if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::RandomPoints)
@@ -195,26 +201,76 @@ void ADynamicMeshBaseActor::RegenerateSourceMesh(FDynamicMesh3& MeshOut)
 				return;
 			FRandomPointsMeshGenerator RandomPointsMeshGenerator;
 			RandomPointsMeshGenerator.InputVertices = RandomPoints;
+			RandomPointsMeshGenerator.ExtrusionDepth = ExtrusionDepth;
 			MeshOut.Copy(&RandomPointsMeshGenerator.Generate());
 		}
 		else if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::Delaunay)
 		{
 			if (RandomPoints.Num() < 3)
 				return;
-			FDelaunayGenrator DelaunayGenrator;
-			DelaunayGenrator.InputVertices = RandomPoints;
-			MeshOut.Copy(&DelaunayGenrator.Generate());
+			if (IncrementalDelaunay.IsValid() == false)
+			{
+				IncrementalDelaunay = MakeShared<FIncrementalDelaunayGenerator>();
+			}
+			IncrementalDelaunay->ExtrusionDepth = ExtrusionDepth;
+			IncrementalDelaunay->SetInput(RandomPoints, ConstraintEdges);
+
+			// the triangles are only patched in place if MeshOut is still the mesh written by the last update
+			const bool bFullRebuild = (&MeshOut != &SourceMesh) || (IncrementalDelaunayMeshRevision != MeshRevision);
+			IncrementalDelaunay->UpdateMesh(MeshOut, bFullRebuild);
+
+			// EditMesh() increments MeshRevision after this function returns
+			IncrementalDelaunayMeshRevision = MeshRevision + 1;
 		}
 		else if (this->PrimitiveType == EDynamicMeshActorPrimitiveType::MarchingCubes)
 		{
 			if (SpatialPoints.Num() < 3)
 				return;
 
+			// 在游戏线程上快照探针位置和值, 并行的Implicit只访问这份拷贝
 			TArray<FVector> Positions;
-			for (auto Point : SpatialPoints)
+			TArray<double> Values;
+			Positions.Reserve(SpatialPoints.Num());
+			Values.Reserve(SpatialPoints.Num());
+			for (const AProbe* Point : SpatialPoints)
 			{
-				Positions.Add(Point->GetActorLocation());
+				if (IsValid(Point))
+				{
+					Positions.Add(Point->GetActorLocation());
+					Values.Add(Point->Value);
+				}
 			}
+			if (Positions.Num() < 3)
+				return;
+
+			// cutoff radius of the probe queries, and the largest distance from a probe to the iso surface
+			// NearestDistance keeps the fixed iso value it had before IsoValue was used
+			const double UseIsoValue = (ProbeFieldMode == EDynamicMeshActorProbeFieldMode::NearestDistance) ? 0.5 : (double)IsoValue;
+			double CutoffRadius, SurfaceDistance;
+			FProbeField ProbeField;
+			if (ProbeFieldMode == EDynamicMeshActorProbeFieldMode::Metaball)
+			{
+				CutoffRadius = SurfaceDistance = FMath::Max((double)ProbeInfluenceRadius, 1.0);
+			}
+			else if (ProbeFieldMode == EDynamicMeshActorProbeFieldMode::SmoothMin)
+			{
+				double MaxValue = 0;
+				for (double Value : Values)
+				{
+					MaxValue = FMath::Max(MaxValue, Value);
+				}
+				SurfaceDistance = ProbeSphereRadius * MaxValue + SmoothMinBlend;
+				CutoffRadius = SurfaceDistance + SmoothMinBlend;
+			}
+			else
+			{
+				// the field 100/MinDist drops below the iso value at a distance of 100/IsoValue, probes further away than
+				// twice that can't change the sign of a sample
+				SurfaceDistance = 100.0 / FMath::Max(UseIsoValue, UE_DOUBLE_KINDA_SMALL_NUMBER);
+				CutoffRadius = 2.0 * SurfaceDistance;
+			}
+			ProbeField.Build(Positions, Values, CutoffRadius);
+
 			FMarchingCubes MarchingCubes;
 			MarchingCubes.CubeSize = Cubesize;
 			// find the bounds
@@ -222,28 +278,99 @@ void ADynamicMeshBaseActor::RegenerateSourceMesh(FDynamicMesh3& MeshOut)
 			RTGUtils::FindAABounds(Bounds, Positions);
 
 			MarchingCubes.Bounds = Bounds;
-			MarchingCubes.Bounds.Expand(200);
-			MarchingCubes.IsoValue = 0.5f;
+			MarchingCubes.Bounds.Expand(SurfaceDistance + Cubesize);
+			MarchingCubes.IsoValue = UseIsoValue;
 			MarchingCubes.RootMode = ERootfindingModes::Bisection;
 			MarchingCubes.RootModeSteps = 4;
 			MarchingCubes.bParallelCompute = true;
-			MarchingCubes.Implicit = [this](const FVector3d& Pos)->double
+			if (ProbeFieldMode == EDynamicMeshActorProbeFieldMode::Metaball)
+			{
+				MarchingCubes.Implicit = [&ProbeField](const FVector3d& Pos)->double
+					{
+						return ProbeField.EvaluateMetaball(Pos);
+					};
+			}
+			else if (ProbeFieldMode == EDynamicMeshActorProbeFieldMode::SmoothMin)
+			{
+				MarchingCubes.Implicit = [&ProbeField, SphereRadius = (double)ProbeSphereRadius, Blend = (double)SmoothMinBlend](const FVector3d& Pos)->double
+					{
+						return ProbeField.EvaluateSmoothMin(Pos, SphereRadius, Blend);
+					};
+			}
+			else
+			{
+				MarchingCubes.Implicit = [&ProbeField](const FVector3d& Pos)->double
+					{
+						int32 NearestProbe;
+						double MinDist;
+						if (ProbeField.FindNearest(Pos, NearestProbe, MinDist) == false)
+						{
+							MinDist = ProbeField.GetCutoffRadius();
+						}
+						return 100/MinDist;
+					};
+			}
+
+			if (bIncrementalMarchingCubes)
+			{
+				if (TiledMarchingCubes.IsValid() == false)
 				{
-					double MinDist = BIG_NUMBER;
-					for (auto P : SpatialPoints)
+					TiledMarchingCubes = MakeShared<FTiledMarchingCubesGenerator>();
+				}
+				// the tiles only record which probes moved, so changes to the field itself re-polygonize everything
+				const uint32 SettingsHash = HashCombine(HashCombine(GetTypeHash((uint8)ProbeFieldMode), GetTypeHash(UseIsoValue)),
+					HashCombine(GetTypeHash(CutoffRadius), HashCombine(GetTypeHash(SurfaceDistance), GetTypeHash(ProbeSphereRadius))));
+				const bool bFullRebuild = (&MeshOut != &SourceMesh) || (TiledMarchingCubesMeshRevision != MeshRevision)
+					|| (TiledMarchingCubesSettingsHash != SettingsHash);
+
+				TiledMarchingCubes->IsoValue = UseIsoValue;
+				TiledMarchingCubes->CubeSize = FMath::Max((double)Cubesize, 0.01);
+				TiledMarchingCubes->RootModeSteps = MarchingCubes.RootModeSteps;
+				TiledMarchingCubes->SetProbes(Positions, Values, CutoffRadius, SurfaceDistance);
+
+				// Implicit references the ProbeField on the stack, so it is only set for this update
+				TiledMarchingCubes->Implicit = MarchingCubes.Implicit;
+				TiledMarchingCubes->UpdateMesh(MeshOut, bFullRebuild);
+				TiledMarchingCubes->Implicit = nullptr;
+
+				// EditMesh() increments MeshRevision after this function returns
+				TiledMarchingCubesMeshRevision = MeshRevision + 1;
+				TiledMarchingCubesSettingsHash = SettingsHash;
+			}
+			else if (bSparseMarchingCubes && ProbeFieldMode == EDynamicMeshActorProbeFieldMode::NearestDistance)
+			{
+				// NearestDistance的每个等值面分量都包围至少一个探针: 从探针沿+X步进到场值低于等值面, 再二分出穿越点作为种子
+				TArray<FVector3d> Seeds;
+				Seeds.Reserve(Positions.Num());
+				const double Step = 0.5 * FMath::Max((double)Cubesize, 1.0);
+				for (const FVector3d& Probe : Positions)
+				{
+					double Inside = 0, Outside = Step;
+					while (Outside < SurfaceDistance + Step && MarchingCubes.Implicit(Probe + FVector3d(Outside, 0, 0)) >= UseIsoValue)
 					{
-						double distance = FVector3d::Dist(Pos, P->GetActorLocation());
-						
-						
-						if(distance < MinDist)
+						Inside = Outside;
+						Outside += Step;
+					}
+					for (int32 k = 0; k < 8; ++k)
+					{
+						const double Mid = 0.5 * (Inside + Outside);
+						if (MarchingCubes.Implicit(Probe + FVector3d(Mid, 0, 0)) >= UseIsoValue)
+						{
+							Inside = Mid;
+						}
+						else
 						{
-							MinDist = distance;
+							Outside = Mid;
 						}
 					}
-					return 100/MinDist;
-				};
-
-			MeshOut.Copy(&MarchingCubes.Generate());
+					Seeds.Add(Probe + FVector3d(0.5 * (Inside + Outside), 0, 0));
+				}
+				MeshOut.Copy(&MarchingCubes.GenerateContinuation(Seeds));
+			}
+			else
+			{
+				MeshOut.Copy(&MarchingCubes.Generate());
+			}
 		}
 	}
 	else if (SourceType == EDynamicMeshActorSourceType::ImportedMesh)
@@ -254,25 +381,74 @@ void ADynamicMeshBaseActor::RegenerateSourceMesh(FDynamicMesh3& MeshOut)
 			UsePath = FPaths::ProjectContentDir() + ImportPath;
 		}
 
+		// Reads the file and applies the import settings, including normals
+		auto BuildImportedMesh = [this, &UsePath](FDynamicMesh3& ImportedMesh)
+		{
+			const FString CacheOptionsKey = FString::Printf(TEXT("OBJ_Reverse%d_Colors%d"), bReverseOrientation ? 1 : 0, bImportVertexColors ? 1 : 0);
+			if (bUseImportCache && RTGUtils::ReadMeshCache(UsePath, CacheOptionsKey, ImportedMesh))
+			{
+				// loaded from the binary cache, the OBJ file has not changed since it was written
+			}
+			else if (RTGUtils::ReadOBJMeshParallel(UsePath, ImportedMesh, true, true, bImportVertexColors, bReverseOrientation))
+			{
+				if (bUseImportCache)
+				{
+					RTGUtils::WriteMeshCache(UsePath, CacheOptionsKey, ImportedMesh);
+				}
+			}
+			else
+			{
+				return false;
+			}
+
+			if (bCenterPivot)
+			{
+				MeshTransforms::Translate(ImportedMesh, -ImportedMesh.GetBounds().Center());
+			}
+
+			if (ImportScale != 1.0)
+			{
+				MeshTransforms::Scale(ImportedMesh, ImportScale * FVector3d::One(), FVector3d::Zero());
+			}
+
+			RecomputeNormals(ImportedMesh);
+			return true;
+		};
+
+		UMeshImportCacheSubsystem* ImportCache = (bUseSharedImportCache) ? UMeshImportCacheSubsystem::Get() : nullptr;
+		TSharedPtr<const FDynamicMesh3> SharedMesh;
+		bool bImported = false;
 		MeshOut = FDynamicMesh3();
-		if (!RTGUtils::ReadOBJMesh(UsePath, MeshOut, true, true, true, bReverseOrientation))
+		if (ImportCache)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Error reading mesh file %s"), *UsePath);
-			FSphereGenerator SphereGen;
-			SphereGen.NumPhi = SphereGen.NumTheta = 8;
-			SphereGen.Radius = this->MinimumRadius;
-			MeshOut.Copy(&SphereGen.Generate());
+			const FString FullPath = FPaths::ConvertRelativePathToFull(UsePath);
+			const FString SharedKey = FString::Printf(TEXT("%s|%s|Reverse%d|Colors%d|Center%d|Scale%g|Normals%d"),
+				*FullPath, *IFileManager::Get().GetTimeStamp(*FullPath).ToString(),
+				bReverseOrientation ? 1 : 0, bImportVertexColors ? 1 : 0, bCenterPivot ? 1 : 0, ImportScale, (int32)NormalsMode);
+			SharedMesh = ImportCache->FindOrBuild(SharedKey, BuildImportedMesh);
+			if (SharedMesh.IsValid())
+			{
+				MeshOut = *SharedMesh;
+				bImported = true;
+			}
 		}
-
-		if (bCenterPivot)
+		else
 		{
-			MeshTransforms::Translate(MeshOut, -MeshOut.GetBounds().Center());
+			bImported = BuildImportedMesh(MeshOut);
 		}
 
-		if (ImportScale != 1.0)
+		if (bImported)
 		{
-			MeshTransforms::Scale(MeshOut, ImportScale * FVector3d::One(), FVector3d::Zero());
+			bImportedMeshHasVertexColors = MeshOut.HasVertexColors();
+			// normals were computed with the import settings
+			return;
 		}
+
+		UE_LOG(LogTemp, Warning, TEXT("Error reading mesh file %s"), *UsePath);
+		FSphereGenerator SphereGen;
+		SphereGen.NumPhi = SphereGen.NumTheta = 8;
+		SphereGen.Radius = this->MinimumRadius;
+		MeshOut.Copy(&SphereGen.Generate());
 	}
 	else if (SourceType == EDynamicMeshActorSourceType::FromStaticMesh)
 	{
@@ -306,6 +482,81 @@ void ADynamicMeshBaseActor::RecomputeNormals(FDynamicMesh3& MeshOut)
 
 
 
+void ADynamicMeshBaseActor::GetScaledPrimitiveMesh(FDynamicMesh3& MeshOut, double Radius)
+{
+	const int32 TessLevel = (PrimitiveType == EDynamicMeshActorPrimitiveType::Box) ? FMath::Clamp(this->TessellationLevel, 2, 50) : FMath::Clamp(this->TessellationLevel, 3, 50);
+	const float DepthRatio = (PrimitiveType == EDynamicMeshActorPrimitiveType::Box) ? BoxDepthRatio : 1.0f;
+
+	TSharedPtr<FDynamicMesh3> UnitMesh;
+	for (int32 k = 0; k < CachedPrimitiveMeshes.Num(); ++k)
+	{
+		const FCachedPrimitiveMesh& Entry = CachedPrimitiveMeshes[k];
+		if (Entry.PrimitiveType == PrimitiveType
+			&& Entry.TessellationLevel == TessLevel
+			&& Entry.BoxDepthRatio == DepthRatio
+			&& Entry.NormalsMode == NormalsMode)
+		{
+			// move to the back so the least-recently used entry is evicted first
+			FCachedPrimitiveMesh Found = Entry;
+			CachedPrimitiveMeshes.RemoveAt(k);
+			CachedPrimitiveMeshes.Add(Found);
+			UnitMesh = Found.UnitMesh;
+			break;
+		}
+	}
+
+	if (UnitMesh.IsValid() == false)
+	{
+		FCachedPrimitiveMesh NewEntry;
+		NewEntry.PrimitiveType = PrimitiveType;
+		NewEntry.TessellationLevel = TessLevel;
+		NewEntry.BoxDepthRatio = DepthRatio;
+		NewEntry.NormalsMode = NormalsMode;
+		NewEntry.UnitMesh = MakeShared<FDynamicMesh3>();
+		if (PrimitiveType == EDynamicMeshActorPrimitiveType::Sphere)
+		{
+			FSphereGenerator SphereGen;
+			SphereGen.NumPhi = SphereGen.NumTheta = TessLevel;
+			SphereGen.Radius = 1.0;
+			NewEntry.UnitMesh->Copy(&SphereGen.Generate());
+		}
+		else
+		{
+			FGridBoxMeshGenerator BoxGen;
+			BoxGen.EdgeVertices = FIndex3i(TessLevel, TessLevel, TessLevel);
+			FVector3d BoxExtents = FVector3d::One();
+			BoxExtents.Z *= DepthRatio;
+			BoxGen.Box = FOrientedBox3d(FVector3d::Zero(), BoxExtents);
+			NewEntry.UnitMesh->Copy(&BoxGen.Generate());
+		}
+		RecomputeNormals(*NewEntry.UnitMesh);
+
+		if (CachedPrimitiveMeshes.Num() >= MaxCachedPrimitiveMeshes)
+		{
+			CachedPrimitiveMeshes.RemoveAt(0);
+		}
+		CachedPrimitiveMeshes.Add(NewEntry);
+		UnitMesh = NewEntry.UnitMesh;
+	}
+
+	// MeshOut has the topology of UnitMesh if nothing edited it since it was written, eg with bRegenerateOnTick
+	const bool bSameTopology = (&MeshOut == &SourceMesh) && (LastPrimitiveUnitMesh == UnitMesh) && (LastPrimitiveMeshRevision == MeshRevision);
+	if (bSameTopology == false)
+	{
+		MeshOut = *UnitMesh;
+	}
+	for (int32 vid : UnitMesh->VertexIndicesItr())
+	{
+		MeshOut.SetVertex(vid, UnitMesh->GetVertex(vid) * Radius);
+	}
+
+	// EditMesh() increments MeshRevision after RegenerateSourceMesh() returns
+	LastPrimitiveUnitMesh = (&MeshOut == &SourceMesh) ? UnitMesh : nullptr;
+	LastPrimitiveMeshRevision = MeshRevision + 1;
+}
+
+
+
 int ADynamicMeshBaseActor::GetTriangleCount()
 {
 	return SourceMesh.TriangleCount();
@@ -412,64 +663,416 @@ void ADynamicMeshBaseActor::IntersectWithMesh(ADynamicMeshBaseActor* OtherMeshAc
 }
 
 
-void ADynamicMeshBaseActor::BooleanWithMesh(ADynamicMeshBaseActor* OtherMeshActor, EDynamicMeshActorBooleanOperation Operation)
+namespace DynamicMeshBooleanLocal
 {
-	if (ensure(OtherMeshActor) == false) return;
-
-	FTransform3d ActorToWorld(GetActorTransform());
-	FTransform3d OtherToWorld(OtherMeshActor->GetActorTransform());
-
-	FDynamicMesh3 OtherMesh;
-	OtherMeshActor->GetMeshCopy(OtherMesh);
-	MeshTransforms::ApplyTransform(OtherMesh, OtherToWorld);
-	MeshTransforms::ApplyTransformInverse(OtherMesh, ActorToWorld);
-
-	EditMesh([&](FDynamicMesh3& MeshToUpdate) {
-
-		FDynamicMesh3 ResultMesh;
-
-		FMeshBoolean::EBooleanOp ApplyOp = FMeshBoolean::EBooleanOp::Union;
+	static FMeshBoolean::EBooleanOp GetMeshBooleanOp(EDynamicMeshActorBooleanOperation Operation)
+	{
 		switch (Operation)
 		{
 		default:
-			break;
+			return FMeshBoolean::EBooleanOp::Union;
 		case EDynamicMeshActorBooleanOperation::Subtraction:
-			ApplyOp = FMeshBoolean::EBooleanOp::Difference;
-			break;
+			return FMeshBoolean::EBooleanOp::Difference;
 		case EDynamicMeshActorBooleanOperation::Intersection:
-			ApplyOp = FMeshBoolean::EBooleanOp::Intersect;
-			break;
+			return FMeshBoolean::EBooleanOp::Intersect;
 		}
+	}
 
+	/**
+	 * Run FMeshBoolean on two meshes that are already in the same space, result is stored in ResultMesh.
+	 * If the boolean fails to weld the cut, the boundary loops it left open are filled in place (pre-existing
+	 * open boundaries of the inputs are not touched), so the result stays closed for winding-number queries.
+	 */
+	static void ComputeBoolean(const FDynamicMesh3& TargetMesh, const FDynamicMesh3& ToolMesh, EDynamicMeshActorBooleanOperation Operation,
+		bool bRepairFailure, FDynamicMesh3& ResultMesh, FDynamicMeshBooleanResult& ResultOut, double WindingThreshold = 0.5)
+	{
 		FMeshBoolean Boolean(
-			&MeshToUpdate, FTransform3d::Identity,
-			&OtherMesh, FTransform3d::Identity,
+			&TargetMesh, FTransform3d::Identity,
+			&ToolMesh, FTransform3d::Identity,
 			&ResultMesh,
-			ApplyOp);
+			GetMeshBooleanOp(Operation));
 		Boolean.bPutResultInInputSpace = true;
-		bool bOK = Boolean.Compute();
+		Boolean.WindingThreshold = WindingThreshold;
+		ResultOut.bSucceeded = Boolean.Compute();
+		ResultOut.NumOpenBoundaryEdges = Boolean.CreatedBoundaryEdges.Num();
+
+		if (!ResultOut.bSucceeded && bRepairFailure)
+		{
+			int32 NumFilled = 0, NumFailed = 0;
+			RTGUtils::FillMeshHoles(ResultMesh, NumFilled, NumFailed, &Boolean.CreatedBoundaryEdges);
+			ResultOut.NumFilledHoles += NumFilled;
+			ResultOut.NumFailedHoleFills += NumFailed;
+		}
+	}
+}
+
+
+ADynamicMeshBaseActor::FCachedToolMesh ADynamicMeshBaseActor::GetToolMeshInLocalSpace(ADynamicMeshBaseActor* ToolActor, int32 CacheCapacity)
+{
+	FTransform3d ActorToWorld(GetActorTransform());
+	FTransform3d OtherToWorld(ToolActor->GetActorTransform());
+	FTransform3d ToolToLocal = OtherToWorld.GetRelativeTransform(ActorToWorld);
+	const uint64 ToolRevision = ToolActor->GetMeshRevision();
+
+	// drop entries for destroyed tools
+	CachedToolMeshes.RemoveAll([](const FCachedToolMesh& Entry) { return Entry.ToolActor.IsValid() == false; });
 
-		if (!bOK)
+	for (int32 k = 0; k < CachedToolMeshes.Num(); ++k)
+	{
+		const FCachedToolMesh& Entry = CachedToolMeshes[k];
+		if (Entry.ToolActor.Get() == ToolActor
+			&& Entry.ToolMeshRevision == ToolRevision
+			&& Entry.ToolToLocal.Equals(ToolToLocal, UE_KINDA_SMALL_NUMBER))
 		{
-			// fill holes
+			// move to the back so the least-recently used entry is evicted first
+			FCachedToolMesh Found = Entry;
+			CachedToolMeshes.RemoveAt(k);
+			CachedToolMeshes.Add(Found);
+			return Found;
 		}
+	}
 
-		RecomputeNormals(ResultMesh);
+	FCachedToolMesh NewEntry;
+	NewEntry.ToolActor = ToolActor;
+	NewEntry.ToolMeshRevision = ToolRevision;
+	NewEntry.ToolToLocal = ToolToLocal;
+	NewEntry.Mesh = MakeShared<FDynamicMesh3>(ToolActor->GetMeshRef());
 
-		MeshToUpdate = MoveTemp(ResultMesh);
+	// Composing the two transforms is only exact if neither has non-uniform scale (which can introduce shear
+	// when combined with rotation), otherwise apply them one after the other
+	if (ActorToWorld.GetScale3D().IsUniform() && OtherToWorld.GetScale3D().IsUniform())
+	{
+		MeshTransforms::ApplyTransform(*NewEntry.Mesh, ToolToLocal);
+	}
+	else
+	{
+		MeshTransforms::ApplyTransform(*NewEntry.Mesh, OtherToWorld);
+		MeshTransforms::ApplyTransformInverse(*NewEntry.Mesh, ActorToWorld);
+	}
+	NewEntry.Bounds = NewEntry.Mesh->GetBounds(true);
+
+	while (CachedToolMeshes.Num() > 0 && CachedToolMeshes.Num() >= FMath::Max(CacheCapacity, MaxCachedToolMeshes))
+	{
+		CachedToolMeshes.RemoveAt(0);
+	}
+	CachedToolMeshes.Add(NewEntry);
+
+	return NewEntry;
+}
+
+
+bool ADynamicMeshBaseActor::ApplyBooleanToMesh(FDynamicMesh3& TargetMesh, const FDynamicMesh3& ToolMesh, EDynamicMeshActorBooleanOperation Operation)
+{
+	FDynamicMeshBooleanResult Result;
+	if (bLocalizedBoolean == false || ApplyLocalizedBooleanToMesh(TargetMesh, ToolMesh, Operation, Result) == false)
+	{
+		Result = FDynamicMeshBooleanResult();
+		FDynamicMesh3 ResultMesh;
+		DynamicMeshBooleanLocal::ComputeBoolean(TargetMesh, ToolMesh, Operation, bRepairFailedBooleans, ResultMesh, Result);
+		TargetMesh = MoveTemp(ResultMesh);
+	}
+
+	if (!Result.bSucceeded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[%s] Boolean left %d open boundary edges, filled %d holes, %d hole fills failed"),
+			*GetName(), Result.NumOpenBoundaryEdges, Result.NumFilledHoles, Result.NumFailedHoleFills);
+	}
+	LastBooleanResult = Result;
+
+	RecomputeNormals(TargetMesh);
+	return Result.bSucceeded;
+}
+
+
+bool ADynamicMeshBaseActor::ApplyLocalizedBooleanToMesh(FDynamicMesh3& TargetMesh, const FDynamicMesh3& ToolMesh, EDynamicMeshActorBooleanOperation Operation, FDynamicMeshBooleanResult& ResultOut)
+{
+	// An intersection discards all of the target outside the tool, including the region boundary, so there is
+	// nothing to stitch back and the region result cannot be validated against the region boundary
+	if (Operation == EDynamicMeshActorBooleanOperation::Intersection
+		|| TargetMesh.TriangleCount() == 0 || ToolMesh.TriangleCount() == 0)
+	{
+		return false;
+	}
+
+	// Find the triangles of TargetMesh whose bounds overlap the (expanded) tool bounds
+	FAxisAlignedBox3d RegionBounds = ToolMesh.GetBounds(true);
+	RegionBounds.Expand(FMath::Max(LocalizedBooleanMargin, 0.0f) * RegionBounds.MaxDim());
+
+	FDynamicMeshAABBTree3 LocalTree;
+	FDynamicMeshAABBTree3* TargetTree = &LocalTree;
+	if (&TargetMesh == &SourceMesh)
+	{
+		// EditMesh() keeps MeshAABBTree up to date when spatial queries are enabled, otherwise it may be stale
+		if ((bEnableSpatialQueries || bEnableInsideQueries) == false || MeshAABBTree.IsValid(false) == false)
+		{
+			MeshAABBTree.Build();
+		}
+		TargetTree = &MeshAABBTree;
+	}
+	else
+	{
+		LocalTree.SetMesh(&TargetMesh, true);
+	}
+
+	TArray<int> RegionTriangles;
+	FDynamicMeshAABBTree3::FTreeTraversal Traversal;
+	Traversal.NextBoxF = [&RegionBounds](const FAxisAlignedBox3d& Box, int Depth)
+	{
+		return Box.Intersects(RegionBounds);
+	};
+	Traversal.NextTriangleF = [&RegionBounds, &RegionTriangles, &TargetMesh](int TriangleID)
+	{
+		if (RegionBounds.Intersects(TargetMesh.GetTriBounds(TriangleID)))
+		{
+			RegionTriangles.Add(TriangleID);
+		}
+	};
+	TargetTree->DoTraversal(Traversal);
+
+	// If nothing overlaps, the tool may still be entirely inside the target, and if most of the mesh overlaps
+	// there is nothing to gain. In both cases let the caller run the full boolean.
+	if (RegionTriangles.Num() == 0 || RegionTriangles.Num() > TargetMesh.TriangleCount() / 2)
+	{
+		return false;
+	}
+
+	FDynamicSubmesh3 Region(&TargetMesh, RegionTriangles);
+	const FDynamicMesh3& RegionMesh = Region.GetSubmesh();
+
+	// The region is an open patch, so the winding number of points inside the target only reaches ~0.5 just below
+	// the patch instead of 1. A lower threshold classifies against the patch reliably as long as the patch extends
+	// well past the tool (see LocalizedBooleanMargin), while remaining a safe threshold for the closed tool mesh.
+	FDynamicMesh3 RegionResult;
+	DynamicMeshBooleanLocal::ComputeBoolean(RegionMesh, ToolMesh, Operation, bRepairFailedBooleans, RegionResult, ResultOut, 0.25);
+
+	// The boolean result is only usable if its open boundary is exactly the region boundary. If the patch was
+	// misclassified (eg a margin too small for the winding threshold), the cut is left open or the patch is
+	// dropped, even though the boolean reports success. Region boundary vertices are hashed by position, with
+	// their target vertex ID, as the boolean does not preserve positions bit-exactly.
+	const double WeldTolerance = FMathd::ZeroTolerance * FMath::Max(1.0, RegionBounds.MaxDim());
+	TPointHashGrid3d<int> RegionBoundaryGrid(100 * WeldTolerance, IndexConstants::InvalidID);
+	int32 NumRegionBoundaryEdges = 0;
+	for (int32 EdgeID : RegionMesh.BoundaryEdgeIndicesItr())
+	{
+		NumRegionBoundaryEdges++;
+		FIndex2i EdgeV = RegionMesh.GetEdgeV(EdgeID);
+		for (int32 j = 0; j < 2; ++j)
+		{
+			RegionBoundaryGrid.InsertPointUnsafe(Region.MapVertexToBaseMesh(EdgeV[j]), RegionMesh.GetVertex(EdgeV[j]));
+		}
+	}
+
+	auto FindRegionBoundaryVertex = [&](const FVector3d& Position)
+	{
+		return RegionBoundaryGrid.FindNearestInRadius(Position, WeldTolerance,
+			[&TargetMesh, &Position](const int& BaseVertexID) { return DistanceSquared(TargetMesh.GetVertex(BaseVertexID), Position); }).Key;
+	};
+
+	TArray<FIndex2i> ResultBoundaryEdges;			// vertices of each open edge of RegionResult
+	TArray<FIndex2i> ResultBoundaryEdgeVerts;		// the matching region boundary vertices in TargetMesh
+	for (int32 EdgeID : RegionResult.BoundaryEdgeIndicesItr())
+	{
+		FIndex2i EdgeV = RegionResult.GetEdgeV(EdgeID);
+		FIndex2i BaseV(FindRegionBoundaryVertex(RegionResult.GetVertex(EdgeV.A)), FindRegionBoundaryVertex(RegionResult.GetVertex(EdgeV.B)));
+		if (BaseV.A == IndexConstants::InvalidID || BaseV.B == IndexConstants::InvalidID)
+		{
+			ResultOut = FDynamicMeshBooleanResult();
+			return false;
+		}
+		ResultBoundaryEdges.Add(EdgeV);
+		ResultBoundaryEdgeVerts.Add(BaseV);
+	}
+	if (ResultBoundaryEdges.Num() != NumRegionBoundaryEdges)
+	{
+		ResultOut = FDynamicMeshBooleanResult();
+		return false;
+	}
+
+	// Replace the region with the boolean result. The region boundary lies outside the tool bounds and is
+	// not modified by the boolean, so each of its edges is welded back to the matching edge of the hole left in
+	// the target. Boundary vertices that do not survive the removal were on open boundaries of the target
+	// already, and stay open. Unrelated open boundaries of the target are never touched.
+	FDynamicMeshEditor Editor(&TargetMesh);
+	Editor.RemoveTriangles(RegionTriangles, true);
+
+	TArray<int32> HoleEdges;
+	for (const FIndex2i& BaseV : ResultBoundaryEdgeVerts)
+	{
+		HoleEdges.Add(TargetMesh.IsVertex(BaseV.A) && TargetMesh.IsVertex(BaseV.B) ?
+			TargetMesh.FindEdge(BaseV.A, BaseV.B) : IndexConstants::InvalidID);
+	}
+
+	FMeshIndexMappings Mappings;
+	Editor.AppendMesh(&RegionResult, Mappings);
+
+	int32 NumFailedWelds = 0;
+	for (int32 k = 0; k < ResultBoundaryEdges.Num(); ++k)
+	{
+		const int32 HoleEdge = HoleEdges[k];
+		if (HoleEdge == IndexConstants::InvalidID || TargetMesh.IsBoundaryEdge(HoleEdge) == false)
+		{
+			continue;		// pre-existing open boundary, or already merged along with a neighbouring edge
+		}
+		// appended vertices that were already merged have been replaced by the hole vertex they matched
+		FIndex2i AppendedV(Mappings.GetNewVertex(ResultBoundaryEdges[k].A), Mappings.GetNewVertex(ResultBoundaryEdges[k].B));
+		AppendedV.A = TargetMesh.IsVertex(AppendedV.A) ? AppendedV.A : ResultBoundaryEdgeVerts[k].A;
+		AppendedV.B = TargetMesh.IsVertex(AppendedV.B) ? AppendedV.B : ResultBoundaryEdgeVerts[k].B;
+		const int32 AppendedEdge = TargetMesh.FindEdge(AppendedV.A, AppendedV.B);
+		FDynamicMesh3::FMergeEdgesInfo MergeInfo;
+		if (AppendedEdge == IndexConstants::InvalidID
+			|| TargetMesh.MergeEdges(HoleEdge, AppendedEdge, MergeInfo) != EMeshResult::Ok)
+		{
+			NumFailedWelds++;
+		}
+	}
+	if (NumFailedWelds > 0)
+	{
+		ResultOut.bSucceeded = false;
+		ResultOut.NumOpenBoundaryEdges += NumFailedWelds;
+	}
+
+	return true;
+}
+
+
+void ADynamicMeshBaseActor::BooleanWithMesh(ADynamicMeshBaseActor* OtherMeshActor, EDynamicMeshActorBooleanOperation Operation)
+{
+	if (ensure(OtherMeshActor) == false) return;
+
+	FCachedToolMesh OtherMesh = GetToolMeshInLocalSpace(OtherMeshActor);
+
+	EditMesh([&](FDynamicMesh3& MeshToUpdate) {
+		ApplyBooleanToMesh(MeshToUpdate, *OtherMesh.Mesh, Operation);
 		});
 }
 
 
+void ADynamicMeshBaseActor::BooleanWithMeshes(const TArray<ADynamicMeshBaseActor*>& OtherMeshActors, EDynamicMeshActorBooleanOperation Operation)
+{
+	TArray<ADynamicMeshBaseActor*> ToolActors;
+	for (ADynamicMeshBaseActor* ToolActor : OtherMeshActors)
+	{
+		if (IsValid(ToolActor) && ToolActor != this)
+		{
+			ToolActors.AddUnique(ToolActor);
+		}
+	}
+	if (ToolActors.Num() == 0)
+	{
+		return;
+	}
+	if (ToolActors.Num() == 1)
+	{
+		BooleanWithMesh(ToolActors[0], Operation);
+		return;
+	}
+
+	auto Start = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	// get all the tools in our local space (cached if they were used before). The cache keeps at least all tools of
+	// this call, otherwise repeating a call with more than MaxCachedToolMeshes tools would evict each tool before its reuse
+	TArray<FCachedToolMesh> ToolMeshes;
+	for (ADynamicMeshBaseActor* ToolActor : ToolActors)
+	{
+		ToolMeshes.Add(GetToolMeshInLocalSpace(ToolActor, ToolActors.Num()));
+	}
+
+	auto ToolsCopied = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	// Combine the tools into a single tool mesh, so that the target is only cut once.
+	// A - (B + C) == (A - B) - C, and A + (B + C) == (A + B) + C, so Subtraction and Union pre-union the tools,
+	// while Intersection has to pre-intersect them. Tools whose bounds do not overlap any previous tool
+	// cannot intersect it, so for union they are simply appended instead of running a boolean.
+	const bool bIntersectTools = (Operation == EDynamicMeshActorBooleanOperation::Intersection);
+	FDynamicMesh3 CombinedTool = *ToolMeshes[0].Mesh;
+	TArray<FAxisAlignedBox3d> CombinedBounds;
+	CombinedBounds.Add(ToolMeshes[0].Bounds);
+	int32 NumAppendedTools = 0;
+	int32 NumToolBooleans = 0;
+	TArray<int32> SeparateTools;		// tools that could not be combined cleanly, applied to the target one by one
+	for (int32 k = 1; k < ToolMeshes.Num(); ++k)
+	{
+		const FDynamicMesh3& ToolMesh = *ToolMeshes[k].Mesh;
+		FAxisAlignedBox3d ToolBounds = ToolMeshes[k].Bounds;
+
+		bool bOverlaps = bIntersectTools;
+		for (int32 j = 0; j < CombinedBounds.Num() && !bOverlaps; ++j)
+		{
+			bOverlaps = CombinedBounds[j].Intersects(ToolBounds);
+		}
+
+		if (bOverlaps)
+		{
+			FDynamicMesh3 CombinedResult;
+			FDynamicMeshBooleanResult ToolResult;
+			DynamicMeshBooleanLocal::ComputeBoolean(CombinedTool, ToolMesh,
+				bIntersectTools ? EDynamicMeshActorBooleanOperation::Intersection : EDynamicMeshActorBooleanOperation::Union,
+				bRepairFailedBooleans, CombinedResult, ToolResult);
+			NumToolBooleans++;
+			if (!ToolResult.bSucceeded)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[%s] Combining tool %s left %d open boundary edges, filled %d holes, %d hole fills failed"),
+					*GetName(), *ToolActors[k]->GetName(), ToolResult.NumOpenBoundaryEdges, ToolResult.NumFilledHoles, ToolResult.NumFailedHoleFills);
+
+				// an open combined tool would break the winding-number classification of the target boolean
+				if (!bRepairFailedBooleans || ToolResult.NumFailedHoleFills > 0)
+				{
+					SeparateTools.Add(k);
+					continue;
+				}
+			}
+			CombinedTool = MoveTemp(CombinedResult);
+		}
+		else
+		{
+			if (ToolMesh.HasTriangleGroups())
+			{
+				CombinedTool.EnableTriangleGroups();
+			}
+			if (ToolMesh.HasAttributes())
+			{
+				CombinedTool.EnableAttributes();
+			}
+			FDynamicMeshEditor Editor(&CombinedTool);
+			FMeshIndexMappings Mappings;
+			Editor.AppendMesh(&ToolMesh, Mappings);
+			NumAppendedTools++;
+		}
+		CombinedBounds.Add(ToolBounds);
+	}
+
+	auto ToolsCombined = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	// single boolean against the target, and a single rebuild of the spatial data structures in EditMesh()
+	double TargetBooleanTime = 0;
+	EditMesh([&](FDynamicMesh3& MeshToUpdate) {
+		auto BooleanStart = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+		ApplyBooleanToMesh(MeshToUpdate, CombinedTool, Operation);
+		for (int32 k : SeparateTools)
+		{
+			ApplyBooleanToMesh(MeshToUpdate, *ToolMeshes[k].Mesh, Operation);
+		}
+		TargetBooleanTime = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds() - BooleanStart;
+		});
+
+	auto End = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	UE_LOG(LogTemp, Display, TEXT("BooleanWithMeshes: %d tools (%d appended, %d tool booleans, %d applied separately). Copy tools: %f ms, Combine tools: %f ms, Target boolean: %f ms, Mesh update: %f ms, Total: %f ms"),
+		ToolActors.Num(), NumAppendedTools, NumToolBooleans, SeparateTools.Num(),
+		ToolsCopied - Start, ToolsCombined - ToolsCopied, TargetBooleanTime, (End - ToolsCombined) - TargetBooleanTime, End - Start);
+}
+
+
 
 bool ADynamicMeshBaseActor::ImportMesh(FString Path, bool bFlipOrientation, bool bRecomputeNormals)
 {
 	FDynamicMesh3 ImportedMesh;
-	if (!RTGUtils::ReadOBJMesh(Path, ImportedMesh, true, true, true, bFlipOrientation))
+	if (!RTGUtils::ReadOBJMeshParallel(Path, ImportedMesh, true, true, bImportVertexColors, bFlipOrientation))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Error reading mesh file %s"), *Path);
 		return false;
 	}
+	bImportedMeshHasVertexColors = ImportedMesh.HasVertexColors();
 
 	if (bRecomputeNormals)
 	{
@@ -689,25 +1292,55 @@ void ADynamicMeshBaseActor::FillHole(int32& NumFilledHoles, int32& NumFailedHole
 }
 
 
+int64 ADynamicMeshBaseActor::GetAttributeMemoryReport(TMap<FName, int64>& AttributeBytes)
+{
+	int64 AttachedBytes = RTGUtils::GetAttachedAttributeByteCounts(SourceMesh, AttributeBytes);
+
+	UE_LOG(LogTemp, Display, TEXT("[%s] Mesh memory (estimated): %lld bytes, %d attached attributes using %lld bytes"),
+		*GetName(), RTGUtils::EstimateMeshByteCount(SourceMesh), AttributeBytes.Num(), AttachedBytes);
+	for (const TPair<FName, int64>& Pair : AttributeBytes)
+	{
+		UE_LOG(LogTemp, Display, TEXT("    %s : %lld bytes"), *Pair.Key.ToString(), Pair.Value);
+	}
+
+	return AttachedBytes;
+}
+
+
 void ADynamicMeshBaseActor::WriteObj(const FString OutputPath)
 {
 	RTGUtils::WriteOBJMesh(OutputPath, SourceMesh, true);
 }
 
+bool ADynamicMeshBaseActor::WriteGlb(const FString OutputPath)
+{
+	return RTGUtils::WriteGLBMesh(OutputPath, SourceMesh);
+}
+
+void ADynamicMeshBaseActor::WriteObjAsync(const FString OutputPath, FOnMeshExportProgress OnProgress, FOnMeshExportComplete OnComplete)
+{
+	TArray<TSharedPtr<const FDynamicMesh3, ESPMode::ThreadSafe>> Meshes;
+	Meshes.Add(MakeShared<FDynamicMesh3, ESPMode::ThreadSafe>(SourceMesh));
+
+	// the delegates are bound to UObjects, ExecuteIfBound() skips them if the object was destroyed before the export finished
+	RTGUtils::WriteOBJMeshesAsync(OutputPath, MoveTemp(Meshes), true,
+		[OnProgress](float Progress) { OnProgress.ExecuteIfBound(Progress); },
+		[OnComplete, OutputPath](bool bSuccess) { OnComplete.ExecuteIfBound(bSuccess, OutputPath); });
+}
+
 void ADynamicMeshBaseActor::PlaneCut(ADynamicMeshBaseActor* OtherMeshActor, FVector PlaneOrigin, FVector PlaneNormal, float GapWidth, bool bFillCutHole, bool bFillSpans, bool bKeepBothHalves)
 {
 	auto Start = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
-	// 给三角形添加自定义属性
-	const FName ObjectIndexAttribute = "ObjectIndexAttribute";
-	TDynamicMeshScalarTriangleAttribute<int>* SubObjectAttrib = new TDynamicMeshScalarTriangleAttribute<int>(&SourceMesh);
-	SubObjectAttrib->Initialize(0);
-	SourceMesh.Attributes()->AttachAttribute(ObjectIndexAttribute, SubObjectAttrib);
 
 	// 拷贝原始Mesh
 	TSharedPtr<FDynamicMesh3, ESPMode::ThreadSafe> SourceMeshPtr = MakeShared<FDynamicMesh3, ESPMode::ThreadSafe>();
 	SourceMeshPtr->Copy(SourceMesh);
 	SourceMeshPtr->EnableAttributes();
 
+	// 给三角形添加自定义属性. Attached to the copy only, so SourceMesh never carries it
+	const FName ObjectIndexAttribute = "ObjectIndexAttribute";
+	RTGUtils::TScopedTriangleAttribute<int> SubObjectAttrib(*SourceMeshPtr, ObjectIndexAttribute, 0);
+
 	// 从世界坐标转换到局部坐标
 	FTransform LocalToWorld = GetTransform();
 	FTransform WorldToLocal = LocalToWorld.Inverse();
@@ -1103,13 +1736,6 @@ void ADynamicMeshBaseActor::AdvancedPlaneCut(ADynamicMeshBaseActor* OtherMeshAct
 
 	SourceMesh.EnableAttributes();
 
-	// 给三角形添加 Object Index 属性
-	const FName ObjectIndexAttribute = "ObjectIndexAttribute";
-	TDynamicMeshScalarTriangleAttribute<int>* SubObjectAttrib = new TDynamicMeshScalarTriangleAttribute<int>(&SourceMesh);
-	SubObjectAttrib->SetName(ObjectIndexAttribute);
-	SubObjectAttrib->Initialize(0);
-	SourceMesh.Attributes()->AttachAttribute(ObjectIndexAttribute, SubObjectAttrib);
-
 	// 从世界坐标转换到局部坐标
 	FTransform LocalToWorld = GetTransform();
 	FTransform WorldToLocal = LocalToWorld.Inverse();
@@ -1120,6 +1746,10 @@ void ADynamicMeshBaseActor::AdvancedPlaneCut(ADynamicMeshBaseActor* OtherMeshAct
 	TSharedPtr<FDynamicMesh3> ResultMesh = MakeShared<FDynamicMesh3>();
 	ResultMesh->Copy(SourceMesh, true, true, true, true);
 
+	// 给三角形添加 Object Index 属性. Attached to the cut copy only, and removed again when we leave this function
+	const FName ObjectIndexAttribute = "ObjectIndexAttribute";
+	RTGUtils::TScopedTriangleAttribute<int> SubObjectAttrib(*ResultMesh, ObjectIndexAttribute, 0);
+
 	FMeshPlaneCut Cut(ResultMesh.Get(), LocalOrigin, LocalNormal);
 	Cut.UVScaleFactor = CutUVScale;
 	Cut.bSimplifyAlongNewEdges = false;
@@ -1132,16 +1762,16 @@ void ADynamicMeshBaseActor::AdvancedPlaneCut(ADynamicMeshBaseActor* OtherMeshAct
 	}
 
 
-	Cut.CutWithoutDelete(true, 0, SubObjectAttrib, MaxSubObjectID + 1);
+	Cut.CutWithoutDelete(true, 0, SubObjectAttrib.Get(), MaxSubObjectID + 1);
 	Cut.HoleFill(ConstrainedDelaunayTriangulate<double>, true);
-	Cut.TransferTriangleLabelsToHoleFillTriangles(SubObjectAttrib);
+	Cut.TransferTriangleLabelsToHoleFillTriangles(SubObjectAttrib.Get());
 
 	// 初始化/设置IsShell属性，该属性会不断往下传递
 	SetIsShell(*ResultMesh, Cut);
 
 	// 根据三角形的SubObjectAttrib划分为两个SourceMesh
 	TArray<FDynamicMesh3> SplitMeshes;
-	bool bSucceeded = SplitMeshInternal::SplitMesh(ResultMesh.Get(), SplitMeshes, [SubObjectAttrib](int TID)
+	bool bSucceeded = SplitMeshInternal::SplitMesh(ResultMesh.Get(), SplitMeshes, [&SubObjectAttrib](int TID)
 		{
 			return SubObjectAttrib->GetValue(TID);
 		});
@@ -0,0 +1,151 @@
+#include "DynamicMeshBinaryCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/LargeMemoryWriter.h"
+
+using namespace UE::Geometry;
+
+namespace MeshCacheLocal
+{
+	static constexpr uint32 CacheMagic = 0x48534D52;		// 'RMSH'
+	static constexpr uint32 CacheVersion = 1;
+
+	/** Identifies the source file and settings the cache was written for. Stored at the start of the cache file. */
+	struct FMeshCacheHeader
+	{
+		uint32 Magic = CacheMagic;
+		uint32 Version = CacheVersion;
+		FString EngineVersion;
+		FString SourcePath;
+		int64 SourceSize = 0;
+		FDateTime SourceTimestamp;
+		FString OptionsKey;
+
+		friend FArchive& operator<<(FArchive& Ar, FMeshCacheHeader& Header)
+		{
+			Ar << Header.Magic << Header.Version;
+			if (Header.Magic != CacheMagic || Header.Version != CacheVersion)
+			{
+				// do not try to read the rest of a file in an unknown format
+				Ar.SetError();
+				return Ar;
+			}
+			Ar << Header.EngineVersion << Header.SourcePath << Header.SourceSize << Header.SourceTimestamp << Header.OptionsKey;
+			return Ar;
+		}
+
+		bool Matches(const FMeshCacheHeader& Other) const
+		{
+			return Magic == Other.Magic && Version == Other.Version
+				&& EngineVersion == Other.EngineVersion
+				&& SourcePath == Other.SourcePath
+				&& SourceSize == Other.SourceSize
+				&& SourceTimestamp == Other.SourceTimestamp
+				&& OptionsKey == Other.OptionsKey;
+		}
+	};
+
+	static FString GetFullSourcePath(const FString& SourcePath)
+	{
+		FString FullPath = FPaths::ConvertRelativePathToFull(SourcePath);
+		FPaths::NormalizeFilename(FullPath);
+		return FullPath;
+	}
+
+	/** Build the header for the current state of the source file, returns false if the file does not exist */
+	static bool MakeHeader(const FString& SourcePath, const FString& OptionsKey, FMeshCacheHeader& HeaderOut)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		HeaderOut.SourcePath = GetFullSourcePath(SourcePath);
+		HeaderOut.SourceSize = FileManager.FileSize(*HeaderOut.SourcePath);
+		if (HeaderOut.SourceSize < 0)
+		{
+			return false;
+		}
+		HeaderOut.SourceTimestamp = FileManager.GetTimeStamp(*HeaderOut.SourcePath);
+		HeaderOut.EngineVersion = FEngineVersion::Current().ToString();
+		HeaderOut.OptionsKey = OptionsKey;
+		return true;
+	}
+}
+
+
+FString RTGUtils::GetMeshCachePath(const FString& SourcePath, const FString& OptionsKey)
+{
+	FString Key = MeshCacheLocal::GetFullSourcePath(SourcePath) + TEXT("|") + OptionsKey;
+	FString BaseName = FPaths::GetBaseFilename(SourcePath) + TEXT("_") + FMD5::HashAnsiString(*Key);
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RuntimeGeometryCache"), BaseName + TEXT(".rgmesh"));
+}
+
+
+bool RTGUtils::ReadMeshCache(
+	const FString& SourcePath,
+	const FString& OptionsKey,
+	FDynamicMesh3& MeshOut)
+{
+	using namespace MeshCacheLocal;
+
+	FMeshCacheHeader ExpectedHeader;
+	if (MakeHeader(SourcePath, OptionsKey, ExpectedHeader) == false)
+	{
+		return false;
+	}
+
+	FString CachePath = GetMeshCachePath(SourcePath, OptionsKey);
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*CachePath, FILEREAD_Silent));
+	if (Reader.IsValid() == false)
+	{
+		return false;
+	}
+
+	// validate the header before reading the (possibly large) mesh, so an out of date cache costs a few bytes
+	FMeshCacheHeader Header;
+	*Reader << Header;
+	if (Reader->IsError() || Header.Matches(ExpectedHeader) == false)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Mesh cache %s is out of date"), *CachePath);
+		return false;
+	}
+
+	FDynamicMesh3 CachedMesh;
+	*Reader << CachedMesh;
+	if (Reader->IsError() || Reader->Close() == false)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error reading mesh cache %s"), *CachePath);
+		return false;
+	}
+
+	MeshOut = MoveTemp(CachedMesh);
+	return true;
+}
+
+
+bool RTGUtils::WriteMeshCache(
+	const FString& SourcePath,
+	const FString& OptionsKey,
+	const FDynamicMesh3& Mesh)
+{
+	using namespace MeshCacheLocal;
+
+	FMeshCacheHeader Header;
+	if (MakeHeader(SourcePath, OptionsKey, Header) == false)
+	{
+		return false;
+	}
+
+	FLargeMemoryWriter Writer(0, true);
+	Writer << Header;
+	// FDynamicMesh3 serialization is non-const, but does not modify the mesh when saving
+	Writer << const_cast<FDynamicMesh3&>(Mesh);
+
+	FString CachePath = GetMeshCachePath(SourcePath, OptionsKey);
+	if (FFileHelper::SaveArrayToFile(TArrayView64<const uint8>(Writer.GetData(), Writer.TotalSize()), *CachePath) == false)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error writing mesh cache %s"), *CachePath);
+		return false;
+	}
+	return true;
+}
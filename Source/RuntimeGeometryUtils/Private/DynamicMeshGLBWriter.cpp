@@ -0,0 +1,339 @@
+#include "DynamicMeshGLBWriter.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "DynamicMesh/DynamicMeshTriangleAttribute.h"
+#include "HAL/FileManager.h"
+#include "Async/ParallelFor.h"
+
+using namespace UE::Geometry;
+
+namespace GLBWriterLocal
+{
+	static constexpr uint32 GLBMagic = 0x46546C67;			// 'glTF'
+	static constexpr uint32 GLBVersion = 2;
+	static constexpr uint32 ChunkTypeJSON = 0x4E4F534A;		// 'JSON'
+	static constexpr uint32 ChunkTypeBIN = 0x004E4942;		// 'BIN\0'
+
+	// glTF accessor/bufferView enums
+	static constexpr int32 ComponentTypeFloat = 5126;
+	static constexpr int32 ComponentTypeUInt = 5125;
+	static constexpr int32 TargetArrayBuffer = 34962;
+	static constexpr int32 TargetElementArrayBuffer = 34963;
+
+	/** centimeters to meters */
+	static constexpr double UnitScale = 0.01;
+
+	/**
+	 * UE (left-handed, Z up) to glTF (right-handed, Y up) is a swap of Y and Z. The swap is a reflection, which
+	 * also turns the UE triangle winding into the counter-clockwise front faces glTF expects, so triangles are
+	 * written in their original order (unlike OBJ export, which has to reverse them).
+	 */
+	FORCEINLINE FVector3f ToGLTFPosition(const FVector3d& Position)
+	{
+		return FVector3f((float)(Position.X * UnitScale), (float)(Position.Z * UnitScale), (float)(Position.Y * UnitScale));
+	}
+
+	FORCEINLINE FVector3f ToGLTFNormal(const FVector3f& Normal)
+	{
+		return FVector3f(Normal.X, Normal.Z, Normal.Y);
+	}
+
+	/** Triangles of one (MaterialID, shell) group and the packed vertex/index arrays they are written as */
+	struct FGLBPrimitive
+	{
+		int32 MaterialID = 0;
+		bool bIsShell = false;
+		TArray<int32> TriangleIDs;
+
+		TArray<FVector3f> Positions;
+		TArray<FVector3f> Normals;
+		TArray<FVector2f> UVs;
+		TArray<FVector4f> Colors;
+		TArray<uint32> Indices;
+		FVector3f MinPosition = FVector3f::Zero();
+		FVector3f MaxPosition = FVector3f::Zero();
+	};
+
+	struct FGLBMeshAttributes
+	{
+		const FDynamicMeshNormalOverlay* Normals = nullptr;
+		const FDynamicMeshUVOverlay* UVs = nullptr;
+		const FDynamicMeshColorOverlay* Colors = nullptr;
+		bool bVertexColors = false;
+
+		bool HasNormals() const { return Normals != nullptr; }
+		bool HasUVs() const { return UVs != nullptr; }
+		bool HasColors() const { return Colors != nullptr || bVertexColors; }
+	};
+
+	/**
+	 * Build the packed arrays of a primitive. An output vertex is a unique (vertex, UV, normal, color) element
+	 * tuple. Most mesh vertices only have one tuple, which is found through a per-vertex table, so only
+	 * vertices on UV/normal/color seams need the map lookup.
+	 */
+	static void BuildPrimitive(const FDynamicMesh3& Mesh, const FGLBMeshAttributes& Attribs, FGLBPrimitive& Prim)
+	{
+		TArray<int32> FirstOutputVertex;
+		FirstOutputVertex.Init(-1, Mesh.MaxVertexID());
+		TArray<FIndex4i> OutputKeys;
+		TMap<FIndex4i, int32> SeamVertices;
+
+		Prim.Indices.Reserve(Prim.TriangleIDs.Num() * 3);
+
+		auto AddVertex = [&](const FIndex4i& Key, int32 tid)
+		{
+			int32 Index = OutputKeys.Add(Key);
+			Prim.Positions.Add(ToGLTFPosition(Mesh.GetVertex(Key.A)));
+			if (Attribs.HasUVs())
+			{
+				Prim.UVs.Add((Key.B >= 0) ? Attribs.UVs->GetElement(Key.B) : FVector2f::Zero());
+			}
+			if (Attribs.HasNormals())
+			{
+				Prim.Normals.Add(ToGLTFNormal((Key.C >= 0) ? Attribs.Normals->GetElement(Key.C) : (FVector3f)Mesh.GetTriNormal(tid)));
+			}
+			if (Attribs.Colors)
+			{
+				Prim.Colors.Add((Key.D >= 0) ? Attribs.Colors->GetElement(Key.D) : FVector4f::One());
+			}
+			else if (Attribs.bVertexColors)
+			{
+				FVector3f Color = Mesh.GetVertexColor(Key.A);
+				Prim.Colors.Add(FVector4f(Color.X, Color.Y, Color.Z, 1.0f));
+			}
+			return Index;
+		};
+
+		for (int32 tid : Prim.TriangleIDs)
+		{
+			FIndex3i Tri = Mesh.GetTriangle(tid);
+			FIndex3i TriUVs = (Attribs.UVs && Attribs.UVs->IsSetTriangle(tid)) ? Attribs.UVs->GetTriangle(tid) : FIndex3i::Invalid();
+			FIndex3i TriNormals = (Attribs.Normals && Attribs.Normals->IsSetTriangle(tid)) ? Attribs.Normals->GetTriangle(tid) : FIndex3i::Invalid();
+			FIndex3i TriColors = (Attribs.Colors && Attribs.Colors->IsSetTriangle(tid)) ? Attribs.Colors->GetTriangle(tid) : FIndex3i::Invalid();
+
+			for (int32 j = 0; j < 3; ++j)
+			{
+				FIndex4i Key(Tri[j], TriUVs[j], TriNormals[j], TriColors[j]);
+				int32 OutputVertex = FirstOutputVertex[Tri[j]];
+				if (OutputVertex < 0)
+				{
+					OutputVertex = AddVertex(Key, tid);
+					FirstOutputVertex[Tri[j]] = OutputVertex;
+				}
+				else if (!(OutputKeys[OutputVertex] == Key))
+				{
+					if (const int32* Found = SeamVertices.Find(Key))
+					{
+						OutputVertex = *Found;
+					}
+					else
+					{
+						OutputVertex = AddVertex(Key, tid);
+						SeamVertices.Add(Key, OutputVertex);
+					}
+				}
+				Prim.Indices.Add((uint32)OutputVertex);
+			}
+		}
+
+		if (Prim.Positions.Num() > 0)
+		{
+			Prim.MinPosition = Prim.MaxPosition = Prim.Positions[0];
+			for (const FVector3f& Position : Prim.Positions)
+			{
+				Prim.MinPosition = FVector3f::Min(Prim.MinPosition, Position);
+				Prim.MaxPosition = FVector3f::Max(Prim.MaxPosition, Position);
+			}
+		}
+	}
+
+	/** One contiguous range of the BIN chunk */
+	struct FGLBBufferView
+	{
+		const void* Data;
+		int64 ByteLength;
+		int32 Target;
+	};
+
+	/** Builds the glTF JSON and the list of buffer views written to the BIN chunk */
+	struct FGLBDocument
+	{
+		TArray<FGLBBufferView> BufferViews;
+		TArray<FString> Accessors;
+		int64 BinLength = 0;
+
+		/** Add a buffer view over Array and an accessor for it, returns the accessor index */
+		template<typename ElementType>
+		int32 AddAccessor(const TArray<ElementType>& Array, int32 ComponentType, const TCHAR* Type, int32 Target, const FString& MinMax = FString())
+		{
+			const int64 ByteLength = (int64)Array.Num() * sizeof(ElementType);
+			int32 ViewIndex = BufferViews.Add({ Array.GetData(), ByteLength, Target });
+			BinLength += ByteLength;		// all element types are multiples of 4 bytes, so views stay aligned
+
+			return Accessors.Add(FString::Printf(TEXT("{\"bufferView\":%d,\"componentType\":%d,\"count\":%d,\"type\":\"%s\"%s}"),
+				ViewIndex, ComponentType, Array.Num(), Type, *MinMax));
+		}
+
+		FString BufferViewsJson() const
+		{
+			TArray<FString> Views;
+			int64 Offset = 0;
+			for (const FGLBBufferView& View : BufferViews)
+			{
+				Views.Add(FString::Printf(TEXT("{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld,\"target\":%d}"), Offset, View.ByteLength, View.Target));
+				Offset += View.ByteLength;
+			}
+			return FString::Join(Views, TEXT(","));
+		}
+	};
+
+	static FString FloatArrayJson(const FVector3f& V)
+	{
+		return FString::Printf(TEXT("[%.9g,%.9g,%.9g]"), V.X, V.Y, V.Z);
+	}
+}
+
+
+bool RTGUtils::WriteGLBMesh(
+	const FString& OutputPath,
+	const FDynamicMesh3& Mesh,
+	FName ShellAttributeName)
+{
+	using namespace GLBWriterLocal;
+
+	FGLBMeshAttributes Attribs;
+	const FDynamicMeshMaterialAttribute* MaterialIDs = nullptr;
+	const TDynamicMeshScalarTriangleAttribute<bool>* ShellAttribute = nullptr;
+	if (const FDynamicMeshAttributeSet* Attributes = Mesh.Attributes())
+	{
+		Attribs.Normals = Attributes->PrimaryNormals();
+		Attribs.UVs = Attributes->PrimaryUV();
+		Attribs.Colors = Attributes->PrimaryColors();
+		MaterialIDs = Attributes->GetMaterialID();
+		if (Attributes->HasAttachedAttribute(ShellAttributeName))
+		{
+			ShellAttribute = static_cast<const TDynamicMeshScalarTriangleAttribute<bool>*>(Attributes->GetAttachedAttribute(ShellAttributeName));
+		}
+	}
+	Attribs.bVertexColors = (Attribs.Colors == nullptr) && Mesh.HasVertexColors();
+
+	// split triangles into (MaterialID, shell) groups
+	TArray<FGLBPrimitive> Primitives;
+	TMap<TPair<int32, bool>, int32> GroupToPrimitive;
+	for (int32 tid : Mesh.TriangleIndicesItr())
+	{
+		int32 MaterialID = (MaterialIDs) ? MaterialIDs->GetValue(tid) : 0;
+		bool bIsShell = (ShellAttribute) ? ShellAttribute->GetValue(tid) : false;
+		int32* PrimitiveIndex = GroupToPrimitive.Find(TPair<int32, bool>(MaterialID, bIsShell));
+		if (PrimitiveIndex == nullptr)
+		{
+			FGLBPrimitive& NewPrimitive = Primitives.AddDefaulted_GetRef();
+			NewPrimitive.MaterialID = MaterialID;
+			NewPrimitive.bIsShell = bIsShell;
+			PrimitiveIndex = &GroupToPrimitive.Add(TPair<int32, bool>(MaterialID, bIsShell), Primitives.Num() - 1);
+		}
+		Primitives[*PrimitiveIndex].TriangleIDs.Add(tid);
+	}
+	Primitives.Sort([](const FGLBPrimitive& A, const FGLBPrimitive& B)
+	{
+		return (A.MaterialID != B.MaterialID) ? (A.MaterialID < B.MaterialID) : (A.bIsShell && !B.bIsShell);
+	});
+
+	ParallelFor(Primitives.Num(), [&](int32 k)
+	{
+		BuildPrimitive(Mesh, Attribs, Primitives[k]);
+	});
+
+	// glTF materials, one per MaterialID
+	TArray<int32> UsedMaterialIDs;
+	for (const FGLBPrimitive& Prim : Primitives)
+	{
+		UsedMaterialIDs.AddUnique(Prim.MaterialID);
+	}
+	TArray<FString> MaterialsJson;
+	for (int32 MaterialID : UsedMaterialIDs)
+	{
+		MaterialsJson.Add(FString::Printf(TEXT("{\"name\":\"Material_%d\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[1,1,1,1],\"metallicFactor\":0,\"roughnessFactor\":1}}"), MaterialID));
+	}
+
+	FGLBDocument Document;
+	TArray<FString> PrimitivesJson;
+	for (const FGLBPrimitive& Prim : Primitives)
+	{
+		FString AttributesJson = FString::Printf(TEXT("\"POSITION\":%d"),
+			Document.AddAccessor(Prim.Positions, ComponentTypeFloat, TEXT("VEC3"), TargetArrayBuffer,
+				FString::Printf(TEXT(",\"min\":%s,\"max\":%s"), *FloatArrayJson(Prim.MinPosition), *FloatArrayJson(Prim.MaxPosition))));
+		if (Attribs.HasNormals())
+		{
+			AttributesJson += FString::Printf(TEXT(",\"NORMAL\":%d"), Document.AddAccessor(Prim.Normals, ComponentTypeFloat, TEXT("VEC3"), TargetArrayBuffer));
+		}
+		if (Attribs.HasUVs())
+		{
+			AttributesJson += FString::Printf(TEXT(",\"TEXCOORD_0\":%d"), Document.AddAccessor(Prim.UVs, ComponentTypeFloat, TEXT("VEC2"), TargetArrayBuffer));
+		}
+		if (Attribs.HasColors())
+		{
+			AttributesJson += FString::Printf(TEXT(",\"COLOR_0\":%d"), Document.AddAccessor(Prim.Colors, ComponentTypeFloat, TEXT("VEC4"), TargetArrayBuffer));
+		}
+		int32 IndicesAccessor = Document.AddAccessor(Prim.Indices, ComponentTypeUInt, TEXT("SCALAR"), TargetElementArrayBuffer);
+
+		PrimitivesJson.Add(FString::Printf(TEXT("{\"attributes\":{%s},\"indices\":%d,\"material\":%d,\"mode\":4,\"extras\":{\"MaterialID\":%d,\"bIsShell\":%s}}"),
+			*AttributesJson, IndicesAccessor, UsedMaterialIDs.IndexOfByKey(Prim.MaterialID), Prim.MaterialID, Prim.bIsShell ? TEXT("true") : TEXT("false")));
+	}
+
+	FString Json = TEXT("{\"asset\":{\"version\":\"2.0\",\"generator\":\"RuntimeGeometryUtils\"},\"scene\":0");
+	if (Primitives.Num() > 0)
+	{
+		Json += TEXT(",\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}]");
+		Json += FString::Printf(TEXT(",\"meshes\":[{\"primitives\":[%s]}]"), *FString::Join(PrimitivesJson, TEXT(",")));
+		Json += FString::Printf(TEXT(",\"materials\":[%s]"), *FString::Join(MaterialsJson, TEXT(",")));
+		Json += FString::Printf(TEXT(",\"accessors\":[%s]"), *FString::Join(Document.Accessors, TEXT(",")));
+		Json += FString::Printf(TEXT(",\"bufferViews\":[%s]"), *Document.BufferViewsJson());
+		Json += FString::Printf(TEXT(",\"buffers\":[{\"byteLength\":%lld}]"), Document.BinLength);
+	}
+	else
+	{
+		Json += TEXT(",\"scenes\":[{\"nodes\":[]}]");
+	}
+	Json += TEXT("}");
+
+	FTCHARToUTF8 JsonUTF8(*Json);
+	const uint32 JsonLength = (uint32)JsonUTF8.Length();
+	const uint32 JsonPadding = (4 - (JsonLength % 4)) % 4;
+	const uint32 JsonChunkLength = JsonLength + JsonPadding;
+	const uint32 BinChunkLength = (uint32)Document.BinLength;
+	if (Document.BinLength > (int64)MAX_uint32 - JsonChunkLength - 28)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Mesh is too large for GLB export: %s"), *OutputPath);
+		return false;
+	}
+	uint32 TotalLength = 12 + 8 + JsonChunkLength + ((BinChunkLength > 0) ? (8 + BinChunkLength) : 0);
+
+	TUniquePtr<FArchive> FileOut(IFileManager::Get().CreateFileWriter(*OutputPath));
+	if (!FileOut.IsValid())
+	{
+		return false;
+	}
+
+	uint32 Magic = GLBMagic, Version = GLBVersion, JsonType = ChunkTypeJSON, BinType = ChunkTypeBIN;
+	uint32 JsonChunkSize = JsonChunkLength, BinChunkSize = BinChunkLength;
+	*FileOut << Magic << Version << TotalLength;
+	*FileOut << JsonChunkSize << JsonType;
+	FileOut->Serialize((void*)JsonUTF8.Get(), JsonLength);
+	for (uint32 k = 0; k < JsonPadding; ++k)
+	{
+		uint8 Space = ' ';
+		*FileOut << Space;
+	}
+
+	if (BinChunkLength > 0)
+	{
+		// the packed primitive arrays are written directly, without copying them into one buffer
+		*FileOut << BinChunkSize << BinType;
+		for (const FGLBBufferView& View : Document.BufferViews)
+		{
+			FileOut->Serialize(const_cast<void*>(View.Data), View.ByteLength);
+		}
+	}
+
+	return FileOut->Close();
+}
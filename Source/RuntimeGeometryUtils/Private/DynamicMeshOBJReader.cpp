@@ -1,6 +1,10 @@
 #include "DynamicMeshOBJReader.h"
 #include "DynamicMesh/DynamicMeshAttributeSet.h"
 #include "tinyobj/tiny_obj_loader.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
 
 using namespace UE::Geometry;
 
@@ -10,7 +14,8 @@ bool RTGUtils::ReadOBJMesh(
 	bool bNormals,
 	bool bTexCoords,
 	bool bVertexColors,
-	bool bReverseOrientation)
+	bool bReverseOrientation,
+	FOBJReadStats* StatsOut)
 {
 	std::string inputfile(TCHAR_TO_UTF8(*Path));
 	tinyobj::attrib_t attrib;
@@ -20,7 +25,8 @@ bool RTGUtils::ReadOBJMesh(
 	std::string warn;
 	std::string err;
 
-	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, inputfile.c_str());
+	// no default color fallback, attrib.colors is left empty unless every vertex in the file has a color
+	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, inputfile.c_str(), nullptr, true, false);
 
 	if (!warn.empty()) {
 		UE_LOG(LogTemp, Display, TEXT("%hs"), warn.c_str());
@@ -45,7 +51,8 @@ bool RTGUtils::ReadOBJMesh(
 	}
 
 
-	if (bVertexColors)
+	const bool bHasColors = attrib.colors.size() == attrib.vertices.size() && attrib.colors.size() > 0;
+	if (bVertexColors && bHasColors)
 	{
 		MeshOut.EnableVertexColors(FVector3f::Zero());
 		for (size_t vi = 0; vi < attrib.vertices.size() / 3; ++vi)
@@ -87,40 +94,78 @@ bool RTGUtils::ReadOBJMesh(
 	}
 
 	// append faces as triangles
+	int32 NumSkippedTriangles = 0;
+	const uint32 NumPositions = (uint32)(attrib.vertices.size() / 3);
+	const uint32 NumNormalElements = (Normals) ? (uint32)Normals->ElementCount() : 0;
+	const uint32 NumUVElements = (UVs) ? (uint32)UVs->ElementCount() : 0;
 	for (size_t s = 0; s < shapes.size(); s++) {	// Loop over shapes
+		const std::vector<tinyobj::index_t>& ShapeIndices = shapes[s].mesh.indices;
+		const std::vector<unsigned char>& FaceSizes = shapes[s].mesh.num_face_vertices;
+
+		// Validate the whole index range of the shape once. Usually all indices are valid, or a shape has no normal/uv
+		// indices at all (-1 in tinyobj), and the per-face checks below are skipped. They are only needed if a shape
+		// mixes faces with and without normals/uvs, or has out-of-range indices.
+		bool bAllVerticesValid = true, bAllNormalsValid = (Normals != nullptr), bAllUVsValid = (UVs != nullptr);
+		bool bAnyNormals = false, bAnyUVs = false;
+		for (const tinyobj::index_t& Index : ShapeIndices)
+		{
+			bAllVerticesValid = bAllVerticesValid && (uint32)Index.vertex_index < NumPositions;
+			bAllNormalsValid = bAllNormalsValid && (uint32)Index.normal_index < NumNormalElements;
+			bAllUVsValid = bAllUVsValid && (uint32)Index.texcoord_index < NumUVElements;
+			bAnyNormals = bAnyNormals || Index.normal_index >= 0;
+			bAnyUVs = bAnyUVs || Index.texcoord_index >= 0;
+		}
+		const bool bCheckFaces = !bAllVerticesValid || (Normals && bAnyNormals && !bAllNormalsValid) || (UVs && bAnyUVs && !bAllUVsValid);
 
 		size_t index_offset = 0;
-		for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {	// Loop over faces(polygon)
-			int fv = shapes[s].mesh.num_face_vertices[f];
+		for (size_t f = 0; f < FaceSizes.size(); f++) {	// Loop over faces(polygon)
+			const int fv = FaceSizes[f];
+			const tinyobj::index_t* FaceIndices = ShapeIndices.data() + index_offset;
+			index_offset += fv;
 
-			TArray<FIndex3i> Triangles;
-			for (size_t v = 1; v < fv - 1; v++)
+			bool bFaceVertices = bAllVerticesValid, bFaceNormals = bAllNormalsValid, bFaceUVs = bAllUVsValid;
+			if (bCheckFaces)
 			{
-				Triangles.Add(FIndex3i(0, v, v + 1));
+				bFaceVertices = true;
+				bFaceNormals = (Normals != nullptr);
+				bFaceUVs = (UVs != nullptr);
+				for (int v = 0; v < fv; v++)
+				{
+					bFaceVertices = bFaceVertices && (uint32)FaceIndices[v].vertex_index < NumPositions;
+					bFaceNormals = bFaceNormals && (uint32)FaceIndices[v].normal_index < NumNormalElements;
+					bFaceUVs = bFaceUVs && (uint32)FaceIndices[v].texcoord_index < NumUVElements;
+				}
+				if (!bFaceVertices)
+				{
+					NumSkippedTriangles += FMath::Max(fv - 2, 0);
+					continue;
+				}
 			}
 
-			int32 NumTris = Triangles.Num();
-			for (int32 ti = 0; ti < NumTris; ++ti)
+			// fan-triangulate the polygon around its first corner
+			const tinyobj::index_t& idx0 = FaceIndices[0];
+			for (int v = 1; v < fv - 1; v++)
 			{
-				FIndex3i TriVerts = Triangles[ti];
-				tinyobj::index_t idx0 = shapes[s].mesh.indices[index_offset + TriVerts.A];
-				tinyobj::index_t idx1 = shapes[s].mesh.indices[index_offset + TriVerts.B];
-				tinyobj::index_t idx2 = shapes[s].mesh.indices[index_offset + TriVerts.C];
+				const tinyobj::index_t& idx1 = FaceIndices[v];
+				const tinyobj::index_t& idx2 = FaceIndices[v + 1];
 
 				int32 tid = MeshOut.AppendTriangle(idx0.vertex_index, idx1.vertex_index, idx2.vertex_index);
+				if (tid < 0)
+				{
+					NumSkippedTriangles++;
+					continue;
+				}
 
-				if (Normals && Normals->IsElement(idx0.normal_index) && Normals->IsElement(idx1.normal_index) && Normals->IsElement(idx2.normal_index))
+				if (bFaceNormals)
 				{
 					Normals->SetTriangle(tid, FIndex3i(idx0.normal_index, idx1.normal_index, idx2.normal_index));
 				}
-				if (UVs && UVs->IsElement(idx0.texcoord_index) && UVs->IsElement(idx1.texcoord_index) && UVs->IsElement(idx2.texcoord_index))
+				if (bFaceUVs)
 				{
 					UVs->SetTriangle(tid, FIndex3i(idx0.texcoord_index, idx1.texcoord_index, idx2.texcoord_index));
 				}
 			}
 
-			index_offset += fv;
-
 			// per-face material
 			//shapes[s].mesh.material_ids[f];
 		}
@@ -131,5 +176,556 @@ bool RTGUtils::ReadOBJMesh(
 		MeshOut.ReverseOrientation();
 	}
 
+	if (StatsOut)
+	{
+		StatsOut->NumVertices = (int32)NumPositions;
+		StatsOut->NumTriangles = MeshOut.TriangleCount();
+		StatsOut->NumTexCoords = (int32)(attrib.texcoords.size() / 2);
+		StatsOut->NumNormals = (int32)(attrib.normals.size() / 3);
+		StatsOut->NumColoredVertices = (bHasColors) ? (int32)NumPositions : 0;
+		StatsOut->bImportedVertexColors = MeshOut.HasVertexColors();
+		StatsOut->NumSkippedTriangles = NumSkippedTriangles;
+	}
+
+	return true;
+}
+
+
+
+
+namespace OBJReaderLocal
+{
+	// files are split into chunks of at least this size for parallel parsing
+	static constexpr int64 MinChunkSize = 1 << 20;
+
+	/** Read-only view of the whole file, memory-mapped if possible */
+	struct FOBJFileView
+	{
+		TUniquePtr<IMappedFileHandle> MappedHandle;
+		TUniquePtr<IMappedFileRegion> MappedRegion;		// declared after MappedHandle so it is released first
+		TArray64<uint8> Buffer;
+		const char* Data = nullptr;
+		int64 Size = 0;
+
+		bool Open(const FString& Path)
+		{
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			FOpenMappedResult MappedResult = PlatformFile.OpenMappedEx(*Path);
+			if (MappedResult.HasValue())
+			{
+				MappedHandle = MappedResult.StealValue();
+				const int64 FileSize = MappedHandle->GetFileSize();
+				if (FileSize > 0)
+				{
+					MappedRegion.Reset(MappedHandle->MapRegion(0, FileSize));
+				}
+				if (MappedRegion.IsValid())
+				{
+					Data = (const char*)MappedRegion->GetMappedPtr();
+					Size = MappedRegion->GetMappedSize();
+					return true;
+				}
+				MappedHandle.Reset();
+			}
+
+			// mapping is not available on all platforms/filesystems (eg pak files), read the file in one block instead
+			if (FFileHelper::LoadFileToArray(Buffer, *Path) == false)
+			{
+				return false;
+			}
+			Data = (const char*)Buffer.GetData();
+			Size = Buffer.Num();
+			return true;
+		}
+	};
+
+	/** Line-aligned range of the file. Counts are filled by the counting pass, Start offsets by the prefix sum over chunks. */
+	struct FOBJChunk
+	{
+		int64 Begin = 0;
+		int64 End = 0;
+
+		int32 NumPositions = 0;
+		int32 NumTexCoords = 0;
+		int32 NumNormals = 0;
+		int32 NumTriangles = 0;
+		int32 NumColors = 0;
+
+		int32 PositionsStart = 0;
+		int32 TexCoordsStart = 0;
+		int32 NormalsStart = 0;
+		int32 TrianglesStart = 0;
+	};
+
+	/** Fan-triangulated face corner indices, zero-based. Missing texcoord/normal indices are -1. */
+	struct FOBJTriangle
+	{
+		FIndex3i Vertices;
+		FIndex3i TexCoords;
+		FIndex3i Normals;
+	};
+
+	struct FOBJData
+	{
+		TArray<FVector3d> Positions;
+		TArray<FVector3f> Colors;
+		TArray<FVector2f> TexCoords;
+		TArray<FVector3f> Normals;
+		TArray<FOBJTriangle> Triangles;
+	};
+
+
+	FORCEINLINE bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	FORCEINLINE bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	FORCEINLINE const char* SkipSpaces(const char* p, const char* End)
+	{
+		while (p < End && IsSpace(*p))
+		{
+			++p;
+		}
+		return p;
+	}
+
+	FORCEINLINE const char* SkipLine(const char* p, const char* End)
+	{
+		while (p < End && *p != '\n')
+		{
+			++p;
+		}
+		return (p < End) ? p + 1 : End;
+	}
+
+	static double Pow10(int32 Exponent)
+	{
+		static const double Table[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		return (Exponent >= 0 && Exponent <= 22) ? Table[Exponent] : FMath::Pow(10.0, (double)Exponent);
+	}
+
+	/** Parse a decimal number (sign, fraction, exponent) at p. Returns false and leaves p unchanged if there is no number. */
+	static bool ParseFloat(const char*& p, const char* End, double& ValueOut)
+	{
+		const char* Cur = SkipSpaces(p, End);
+		bool bNegative = false;
+		if (Cur < End && (*Cur == '-' || *Cur == '+'))
+		{
+			bNegative = (*Cur == '-');
+			++Cur;
+		}
+
+		double Mantissa = 0;
+		int32 NumDigits = 0;
+		int32 Exponent = 0;
+		while (Cur < End && IsDigit(*Cur))
+		{
+			Mantissa = Mantissa * 10.0 + (double)(*Cur - '0');
+			++NumDigits;
+			++Cur;
+		}
+		if (Cur < End && *Cur == '.')
+		{
+			++Cur;
+			while (Cur < End && IsDigit(*Cur))
+			{
+				Mantissa = Mantissa * 10.0 + (double)(*Cur - '0');
+				++NumDigits;
+				--Exponent;
+				++Cur;
+			}
+		}
+		if (NumDigits == 0)
+		{
+			return false;
+		}
+
+		if (Cur < End && (*Cur == 'e' || *Cur == 'E'))
+		{
+			const char* ExpCur = Cur + 1;
+			bool bNegativeExp = false;
+			if (ExpCur < End && (*ExpCur == '-' || *ExpCur == '+'))
+			{
+				bNegativeExp = (*ExpCur == '-');
+				++ExpCur;
+			}
+			int32 ExpValue = 0;
+			int32 NumExpDigits = 0;
+			while (ExpCur < End && IsDigit(*ExpCur))
+			{
+				ExpValue = FMath::Min(ExpValue * 10 + (*ExpCur - '0'), 10000);
+				++NumExpDigits;
+				++ExpCur;
+			}
+			if (NumExpDigits > 0)
+			{
+				Exponent += (bNegativeExp) ? -ExpValue : ExpValue;
+				Cur = ExpCur;
+			}
+		}
+
+		double Value = (Exponent < 0) ? (Mantissa / Pow10(-Exponent)) : (Mantissa * Pow10(Exponent));
+		ValueOut = (bNegative) ? -Value : Value;
+		p = Cur;
+		return true;
+	}
+
+	/** Parse a signed integer at p (no leading spaces). Returns false and leaves p unchanged if there is no number. */
+	static bool ParseInt(const char*& p, const char* End, int32& ValueOut)
+	{
+		const char* Cur = p;
+		bool bNegative = false;
+		if (Cur < End && (*Cur == '-' || *Cur == '+'))
+		{
+			bNegative = (*Cur == '-');
+			++Cur;
+		}
+		if (Cur >= End || IsDigit(*Cur) == false)
+		{
+			return false;
+		}
+		int64 Value = 0;
+		while (Cur < End && IsDigit(*Cur))
+		{
+			Value = FMath::Min(Value * 10 + (*Cur - '0'), (int64)MAX_int32);
+			++Cur;
+		}
+		ValueOut = (int32)((bNegative) ? -Value : Value);
+		p = Cur;
+		return true;
+	}
+
+	/** Convert a one-based (or negative, relative to the elements read so far) OBJ index to a zero-based index, 0 (missing) becomes -1 */
+	FORCEINLINE int32 ResolveIndex(int32 Index, int32 NumReadSoFar)
+	{
+		return (Index > 0) ? (Index - 1) : ((Index < 0) ? (NumReadSoFar + Index) : -1);
+	}
+
+
+	/**
+	 * Parse the records in one chunk. With bWrite=false only the record counts of the chunk are computed,
+	 * with bWrite=true the records are written into Out, starting at the chunk Start offsets.
+	 */
+	template<bool bWrite>
+	static void ParseChunk(const char* Data, FOBJChunk& Chunk, FOBJData* Out)
+	{
+		const char* p = Data + Chunk.Begin;
+		const char* End = Data + Chunk.End;
+
+		int32 NumPositions = 0;
+		int32 NumTexCoords = 0;
+		int32 NumNormals = 0;
+		int32 NumTriangles = 0;
+
+		while (p < End)
+		{
+			p = SkipSpaces(p, End);
+			if (p + 1 >= End)
+			{
+				break;
+			}
+
+			if (p[0] == 'v' && IsSpace(p[1]))
+			{
+				p += 2;
+				double X = 0, Y = 0, Z = 0, R = 1, G = 1, B = 1;
+				ParseFloat(p, End, X);
+				ParseFloat(p, End, Y);
+				ParseFloat(p, End, Z);
+				bool bColor = ParseFloat(p, End, R) && ParseFloat(p, End, G) && ParseFloat(p, End, B);
+				if constexpr (bWrite)
+				{
+					const int32 Index = Chunk.PositionsStart + NumPositions;
+					Out->Positions[Index] = FVector3d(X, Y, Z);
+					if (bColor && Out->Colors.Num() > 0)
+					{
+						Out->Colors[Index] = FVector3f((float)R, (float)G, (float)B);
+					}
+				}
+				else
+				{
+					Chunk.NumColors += (bColor) ? 1 : 0;
+				}
+				NumPositions++;
+			}
+			else if (p[0] == 'v' && p[1] == 't' && p + 2 < End && IsSpace(p[2]))
+			{
+				p += 3;
+				if constexpr (bWrite)
+				{
+					double U = 0, V = 0;
+					ParseFloat(p, End, U);
+					ParseFloat(p, End, V);
+					Out->TexCoords[Chunk.TexCoordsStart + NumTexCoords] = FVector2f((float)U, (float)V);
+				}
+				NumTexCoords++;
+			}
+			else if (p[0] == 'v' && p[1] == 'n' && p + 2 < End && IsSpace(p[2]))
+			{
+				p += 3;
+				if constexpr (bWrite)
+				{
+					double X = 0, Y = 0, Z = 0;
+					ParseFloat(p, End, X);
+					ParseFloat(p, End, Y);
+					ParseFloat(p, End, Z);
+					Out->Normals[Chunk.NormalsStart + NumNormals] = FVector3f((float)X, (float)Y, (float)Z);
+				}
+				NumNormals++;
+			}
+			else if (p[0] == 'f' && IsSpace(p[1]))
+			{
+				p += 2;
+				// polygons are fan-triangulated around the first corner as they are read
+				FIndex3i FirstCorner, PrevCorner;
+				int32 NumCorners = 0;
+				while (true)
+				{
+					p = SkipSpaces(p, End);
+					int32 VertexIndex = 0, TexCoordIndex = 0, NormalIndex = 0;
+					if (ParseInt(p, End, VertexIndex) == false)
+					{
+						break;
+					}
+					if (p < End && *p == '/')
+					{
+						++p;
+						ParseInt(p, End, TexCoordIndex);
+						if (p < End && *p == '/')
+						{
+							++p;
+							ParseInt(p, End, NormalIndex);
+						}
+					}
+					// skip anything else attached to this corner
+					while (p < End && IsSpace(*p) == false && *p != '\r' && *p != '\n')
+					{
+						++p;
+					}
+
+					if constexpr (bWrite)
+					{
+						FIndex3i Corner(
+							ResolveIndex(VertexIndex, Chunk.PositionsStart + NumPositions),
+							ResolveIndex(TexCoordIndex, Chunk.TexCoordsStart + NumTexCoords),
+							ResolveIndex(NormalIndex, Chunk.NormalsStart + NumNormals));
+						if (NumCorners == 0)
+						{
+							FirstCorner = Corner;
+						}
+						else if (NumCorners >= 2)
+						{
+							FOBJTriangle& Tri = Out->Triangles[Chunk.TrianglesStart + NumTriangles];
+							Tri.Vertices = FIndex3i(FirstCorner.A, PrevCorner.A, Corner.A);
+							Tri.TexCoords = FIndex3i(FirstCorner.B, PrevCorner.B, Corner.B);
+							Tri.Normals = FIndex3i(FirstCorner.C, PrevCorner.C, Corner.C);
+						}
+						PrevCorner = Corner;
+					}
+					if (NumCorners >= 2)
+					{
+						NumTriangles++;
+					}
+					NumCorners++;
+				}
+			}
+
+			p = SkipLine(p, End);
+		}
+
+		if constexpr (bWrite == false)
+		{
+			Chunk.NumPositions = NumPositions;
+			Chunk.NumTexCoords = NumTexCoords;
+			Chunk.NumNormals = NumNormals;
+			Chunk.NumTriangles = NumTriangles;
+		}
+	}
+
+	/** Split [0,Size) into line-aligned chunks */
+	static void MakeChunks(const char* Data, int64 Size, TArray<FOBJChunk>& Chunks)
+	{
+		const int64 MaxChunks = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads()) * 4;
+		const int64 NumChunks = FMath::Clamp(Size / MinChunkSize, (int64)1, MaxChunks);
+
+		int64 Begin = 0;
+		for (int64 k = 1; k <= NumChunks && Begin < Size; ++k)
+		{
+			int64 End = (k == NumChunks) ? Size : FMath::Max(Begin, k * Size / NumChunks);
+			while (End < Size && Data[End - 1] != '\n')
+			{
+				++End;
+			}
+			FOBJChunk& Chunk = Chunks.AddDefaulted_GetRef();
+			Chunk.Begin = Begin;
+			Chunk.End = End;
+			Begin = End;
+		}
+	}
+
+	FORCEINLINE bool IsValidIndex(const FIndex3i& Tri, int32 Count)
+	{
+		return (uint32)Tri.A < (uint32)Count && (uint32)Tri.B < (uint32)Count && (uint32)Tri.C < (uint32)Count;
+	}
+}
+
+
+bool RTGUtils::ReadOBJMeshParallel(
+	const FString& Path,
+	FDynamicMesh3& MeshOut,
+	bool bNormals,
+	bool bTexCoords,
+	bool bVertexColors,
+	bool bReverseOrientation,
+	FOBJReadStats* StatsOut)
+{
+	using namespace OBJReaderLocal;
+
+	auto Start = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	FOBJFileView File;
+	if (File.Open(Path) == false)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Cannot open file %s"), *Path);
+		return false;
+	}
+
+	TArray<FOBJChunk> Chunks;
+	MakeChunks(File.Data, File.Size, Chunks);
+
+	// counting pass
+	ParallelFor(Chunks.Num(), [&](int32 k)
+	{
+		ParseChunk<false>(File.Data, Chunks[k], nullptr);
+	});
+
+	FOBJData Data;
+	int64 NumPositions = 0, NumTexCoords = 0, NumNormals = 0, NumTriangles = 0;
+	int64 NumColors = 0;
+	for (FOBJChunk& Chunk : Chunks)
+	{
+		Chunk.PositionsStart = (int32)NumPositions;
+		Chunk.TexCoordsStart = (int32)NumTexCoords;
+		Chunk.NormalsStart = (int32)NumNormals;
+		Chunk.TrianglesStart = (int32)NumTriangles;
+		NumPositions += Chunk.NumPositions;
+		NumTexCoords += Chunk.NumTexCoords;
+		NumNormals += Chunk.NumNormals;
+		NumTriangles += Chunk.NumTriangles;
+		NumColors += Chunk.NumColors;
+	}
+	if (FMath::Max(NumPositions, NumTriangles) >= (int64)MAX_int32)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("OBJ file %s is too large (%lld vertices, %lld triangles)"), *Path, NumPositions, NumTriangles);
+		return false;
+	}
+
+	Data.Positions.SetNumUninitialized((int32)NumPositions);
+	Data.TexCoords.SetNumUninitialized((int32)NumTexCoords);
+	Data.Normals.SetNumUninitialized((int32)NumNormals);
+	Data.Triangles.SetNumUninitialized((int32)NumTriangles);
+	// color storage is only allocated if the file has colors
+	if (bVertexColors && NumColors > 0)
+	{
+		// vertices without colors default to white
+		Data.Colors.Init(FVector3f::One(), (int32)NumPositions);
+	}
+
+	auto Counted = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	// parsing pass
+	ParallelFor(Chunks.Num(), [&](int32 k)
+	{
+		ParseChunk<true>(File.Data, Chunks[k], &Data);
+	});
+
+	auto Parsed = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	// FDynamicMesh3 construction (edge topology) is serial
+	for (const FVector3d& Position : Data.Positions)
+	{
+		MeshOut.AppendVertex(Position);
+	}
+
+	if (Data.Colors.Num() > 0)
+	{
+		MeshOut.EnableVertexColors(FVector3f::One());
+		for (int32 vi = 0; vi < Data.Colors.Num(); ++vi)
+		{
+			MeshOut.SetVertexColor(vi, Data.Colors[vi]);
+		}
+	}
+
+	if (bNormals || bTexCoords)
+	{
+		MeshOut.EnableAttributes();
+	}
+	FDynamicMeshNormalOverlay* Normals = (bNormals) ? MeshOut.Attributes()->PrimaryNormals() : nullptr;
+	FDynamicMeshUVOverlay* UVs = (bTexCoords) ? MeshOut.Attributes()->PrimaryUV() : nullptr;
+	if (Normals)
+	{
+		for (const FVector3f& Normal : Data.Normals)
+		{
+			Normals->AppendElement(Normal);
+		}
+	}
+	if (UVs)
+	{
+		for (const FVector2f& UV : Data.TexCoords)
+		{
+			UVs->AppendElement(UV);
+		}
+	}
+
+	int32 NumSkippedTriangles = 0;
+	for (const FOBJTriangle& Tri : Data.Triangles)
+	{
+		int32 tid = (IsValidIndex(Tri.Vertices, (int32)NumPositions)) ? MeshOut.AppendTriangle(Tri.Vertices) : FDynamicMesh3::InvalidID;
+		if (tid < 0)
+		{
+			NumSkippedTriangles++;
+			continue;
+		}
+		if (Normals && IsValidIndex(Tri.Normals, (int32)NumNormals))
+		{
+			Normals->SetTriangle(tid, Tri.Normals);
+		}
+		if (UVs && IsValidIndex(Tri.TexCoords, (int32)NumTexCoords))
+		{
+			UVs->SetTriangle(tid, Tri.TexCoords);
+		}
+	}
+
+	if (bReverseOrientation)
+	{
+		MeshOut.ReverseOrientation();
+	}
+
+	auto End = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+	if (StatsOut)
+	{
+		StatsOut->NumVertices = (int32)NumPositions;
+		StatsOut->NumTriangles = MeshOut.TriangleCount();
+		StatsOut->NumTexCoords = (int32)NumTexCoords;
+		StatsOut->NumNormals = (int32)NumNormals;
+		StatsOut->NumColoredVertices = (int32)NumColors;
+		StatsOut->bImportedVertexColors = MeshOut.HasVertexColors();
+		StatsOut->NumSkippedTriangles = NumSkippedTriangles;
+	}
+
+	if (NumSkippedTriangles > 0)
+	{
+		UE_LOG(LogTemp, Display, TEXT("%s: skipped %d invalid or non-manifold triangles"), *Path, NumSkippedTriangles);
+	}
+	UE_LOG(LogTemp, Display, TEXT("ReadOBJMeshParallel: %lld vertices (%lld with colors), %lld triangles, %d chunks. Count: %f ms, Parse: %f ms, Build mesh: %f ms, Total: %f ms"),
+		NumPositions, NumColors, NumTriangles, Chunks.Num(), Counted - Start, Parsed - Counted, End - Parsed, End - Start);
+
 	return true;
-}
\ No newline at end of file
+}
@@ -1,8 +1,85 @@
 #include "DynamicMeshOBJWriter.h"
 #include "DynamicMesh/DynamicMeshAttributeSet.h"
-#include "DynamicMeshEditor.h"
 
-#include <fstream>
+#include "HAL/FileManager.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+
+
+
+/**
+ * Growable byte buffer that OBJ records are formatted into directly, without going through FString/TCHAR.
+ * Floats are written like printf("%f") (fixed, 6 decimals).
+ */
+class FOBJTextBuffer
+{
+public:
+	TArray<uint8> Data;
+
+	void Reset()
+	{
+		Data.Reset();
+	}
+
+	FORCEINLINE void AppendChar(char c)
+	{
+		Data.Add((uint8)c);
+	}
+
+	FORCEINLINE void AppendString(const char* String, int32 Length)
+	{
+		Data.Append((const uint8*)String, Length);
+	}
+
+	void AppendInt(int64 Value)
+	{
+		char Digits[24];
+		int32 Num = 0;
+		uint64 Abs = (Value < 0) ? (uint64)(-Value) : (uint64)Value;
+		do
+		{
+			Digits[Num++] = (char)('0' + (Abs % 10));
+			Abs /= 10;
+		} while (Abs != 0);
+		if (Value < 0)
+		{
+			AppendChar('-');
+		}
+		uint8* Out = Data.GetData() + Data.AddUninitialized(Num);
+		for (int32 k = 0; k < Num; ++k)
+		{
+			Out[k] = (uint8)Digits[Num - 1 - k];
+		}
+	}
+
+	void AppendFloat(double Value)
+	{
+		// values that do not fit the fixed-point conversion (huge, NaN, Inf) go through snprintf
+		if (!(FMath::Abs(Value) < 1.0e12))
+		{
+			ANSICHAR Buffer[512];
+			int32 Length = FCStringAnsi::Snprintf(Buffer, sizeof(Buffer), "%f", Value);
+			AppendString(Buffer, FMath::Clamp(Length, 0, (int32)sizeof(Buffer) - 1));
+			return;
+		}
+
+		if (Value < 0)
+		{
+			AppendChar('-');
+			Value = -Value;
+		}
+		const uint64 Scaled = (uint64)(Value * 1000000.0 + 0.5);
+		AppendInt((int64)(Scaled / 1000000));
+		AppendChar('.');
+		uint64 Fraction = Scaled % 1000000;
+		uint8* Out = Data.GetData() + Data.AddUninitialized(6);
+		for (int32 k = 5; k >= 0; --k)
+		{
+			Out[k] = (uint8)('0' + (Fraction % 10));
+			Fraction /= 10;
+		}
+	}
+};
 
 
 
@@ -10,50 +87,194 @@ class FDynamicMeshOBJWriter
 {
 public:
 
-	std::ofstream FileOut;
+	TUniquePtr<FArchive> FileOut;
+
+	/** Number of records formatted per parallel task */
+	int32 RecordsPerChunk = 16384;
+
+	/** If set, called (on the writing thread) with the fraction of records written after each batch */
+	TFunction<void(float)> ProgressCallback;
+
+	int64 TotalRecords = 0;
+	int64 NumRecordsWritten = 0;
+
+	bool OpenFile(const FString& Path)
+	{
+		FileOut.Reset(IFileManager::Get().CreateFileWriter(*Path));
+		return FileOut.IsValid();
+	}
+
+	bool CloseFile()
+	{
+		bool bOK = FileOut.IsValid() && FileOut->Close();
+		FileOut.Reset();
+		return bOK;
+	}
+
+	/**
+	 * Format records [0,Count) with FormatRecord(Buffer, Index), in parallel chunks of RecordsPerChunk,
+	 * and write the chunks to the file in order. Chunks are formatted and written in batches so that
+	 * only a bounded amount of text is held in memory.
+	 */
+	template<typename FormatRecordFunc>
+	void WriteRecords(int32 Count, FormatRecordFunc&& FormatRecord)
+	{
+		const int32 NumChunks = FMath::DivideAndRoundUp(Count, RecordsPerChunk);
+		const int32 ChunksPerBatch = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() * 2);
+		TArray<FOBJTextBuffer> Buffers;
+		Buffers.SetNum(FMath::Min(NumChunks, ChunksPerBatch));
+
+		for (int32 BatchStart = 0; BatchStart < NumChunks; BatchStart += ChunksPerBatch)
+		{
+			const int32 NumBatchChunks = FMath::Min(ChunksPerBatch, NumChunks - BatchStart);
+			ParallelFor(NumBatchChunks, [&](int32 k)
+			{
+				FOBJTextBuffer& Buffer = Buffers[k];
+				Buffer.Reset();
+				const int32 Start = (BatchStart + k) * RecordsPerChunk;
+				const int32 End = FMath::Min(Start + RecordsPerChunk, Count);
+				for (int32 Index = Start; Index < End; ++Index)
+				{
+					FormatRecord(Buffer, Index);
+				}
+			});
+			for (int32 k = 0; k < NumBatchChunks; ++k)
+			{
+				FileOut->Serialize(Buffers[k].Data.GetData(), Buffers[k].Data.Num());
+			}
+
+			NumRecordsWritten += FMath::Min((BatchStart + NumBatchChunks) * RecordsPerChunk, Count) - BatchStart * RecordsPerChunk;
+			if (ProgressCallback && TotalRecords > 0)
+			{
+				ProgressCallback((float)((double)NumRecordsWritten / (double)TotalRecords));
+			}
+		}
+	}
+
+	/** Build the list of valid IDs and, if the IDs are not compact, the mapping from ID to sequential index */
+	template<typename IndicesEnumerable>
+	static void MakeIndexMap(IndicesEnumerable Indices, int32 MaxID, TArray<int32>& IDs, TArray<int32>& IDToIndex)
+	{
+		IDs.Reset();
+		for (int32 ID : Indices)
+		{
+			IDs.Add(ID);
+		}
+		IDToIndex.Reset();
+		if (IDs.Num() != MaxID)
+		{
+			IDToIndex.Init(-1, MaxID);
+			for (int32 k = 0; k < IDs.Num(); ++k)
+			{
+				IDToIndex[IDs[k]] = k;
+			}
+		}
+	}
 
-	TFunction<bool(const FString&)> OpenFile = [this](const FString& Path) { FileOut.open(*Path, std::ofstream::out | std::ofstream::trunc); return !!FileOut; };
-	TFunction<void()> CloseFile = [this]() { FileOut.close(); };
-	TFunction<void(const TCHAR*)> WriteLine = [this](const TCHAR* Line) { FileOut << TCHAR_TO_ANSI(Line) << std::endl; };
+	static FORCEINLINE int32 MapIndex(const TArray<int32>& IDToIndex, int32 ID)
+	{
+		return (IDToIndex.Num() > 0) ? IDToIndex[ID] : ID;
+	}
 
-	bool Write(const char* OutputPath, const FDynamicMesh3& Mesh)
+	/**
+	 * Write the meshes to OutputPath, one after the other. The records of each mesh are written with index
+	 * offsets of the meshes before it, so no combined mesh is built. Triangle groups of different meshes
+	 * are written as different OBJ groups.
+	 * @param bReverseOrientation if true, triangles are written with reversed orientation and normals are negated (as FDynamicMesh3::ReverseOrientation())
+	 */
+	bool Write(const FString& OutputPath, TArrayView<const FDynamicMesh3* const> Meshes, bool bReverseOrientation)
 	{
 		if (!OpenFile(OutputPath))
 		{
 			return false;
 		}
 
-		int32 NumVertices = Mesh.VertexCount();
-		for (int32 vi = 0; vi < NumVertices; ++vi)
+		TotalRecords = 0;
+		NumRecordsWritten = 0;
+		for (const FDynamicMesh3* Mesh : Meshes)
+		{
+			TotalRecords += Mesh->VertexCount() + Mesh->TriangleCount();
+			if (Mesh->Attributes() && Mesh->Attributes()->PrimaryUV())
+			{
+				TotalRecords += Mesh->Attributes()->PrimaryUV()->ElementCount();
+			}
+			if (Mesh->Attributes() && Mesh->Attributes()->PrimaryNormals())
+			{
+				TotalRecords += Mesh->Attributes()->PrimaryNormals()->ElementCount();
+			}
+		}
+
+		FIndex3i IndexOffsets = FIndex3i::Zero();
+		int32 GroupOffset = 0;
+		for (const FDynamicMesh3* Mesh : Meshes)
 		{
-			FVector3d Pos = Mesh.GetVertex(vi);
-			WriteLine(*FString::Printf(TEXT("v %f %f %f"), Pos.X, Pos.Y, Pos.Z));
+			WriteMesh(*Mesh, bReverseOrientation, Meshes.Num() > 1, IndexOffsets, GroupOffset);
 		}
 
+		return CloseFile();
+	}
+
+protected:
+
+	/**
+	 * Write the records of one mesh. IndexOffsets is the number of vertices/UVs/normals written before
+	 * this mesh (and is updated), GroupOffset is added to the triangle group IDs (and is updated)
+	 */
+	void WriteMesh(const FDynamicMesh3& Mesh, bool bReverseOrientation, bool bAlwaysWriteGroups, FIndex3i& IndexOffsets, int32& GroupOffset)
+	{
+		TArray<int32> VertexIDs, VertexIndexMap;
+		MakeIndexMap(Mesh.VertexIndicesItr(), Mesh.MaxVertexID(), VertexIDs, VertexIndexMap);
+		WriteRecords(VertexIDs.Num(), [&](FOBJTextBuffer& Buffer, int32 Index)
+		{
+			FVector3d Pos = Mesh.GetVertex(VertexIDs[Index]);
+			Buffer.AppendString("v ", 2);
+			Buffer.AppendFloat(Pos.X);
+			Buffer.AppendChar(' ');
+			Buffer.AppendFloat(Pos.Y);
+			Buffer.AppendChar(' ');
+			Buffer.AppendFloat(Pos.Z);
+			Buffer.AppendChar('\n');
+		});
+
 		int32 NumUVs = 0;
 		const FDynamicMeshUVOverlay* UVs = nullptr;
+		TArray<int32> UVIDs, UVIndexMap;
 		if (Mesh.Attributes() && Mesh.Attributes()->PrimaryUV())
 		{
 			UVs = Mesh.Attributes()->PrimaryUV();
-			NumUVs = UVs->ElementCount();
-			for (int32 ui = 0; ui < NumUVs; ++ui)
+			MakeIndexMap(UVs->ElementIndicesItr(), UVs->MaxElementID(), UVIDs, UVIndexMap);
+			NumUVs = UVIDs.Num();
+			WriteRecords(NumUVs, [&](FOBJTextBuffer& Buffer, int32 Index)
 			{
-				FVector2f UV = UVs->GetElement(ui);
-				WriteLine(*FString::Printf(TEXT("vt %f %f"), UV.X, UV.Y));
-			}
+				FVector2f UV = UVs->GetElement(UVIDs[Index]);
+				Buffer.AppendString("vt ", 3);
+				Buffer.AppendFloat(UV.X);
+				Buffer.AppendChar(' ');
+				Buffer.AppendFloat(UV.Y);
+				Buffer.AppendChar('\n');
+			});
 		}
 
 		int32 NumNormals = 0;
 		const FDynamicMeshNormalOverlay* Normals = nullptr;
+		TArray<int32> NormalIDs, NormalIndexMap;
 		if (Mesh.Attributes() && Mesh.Attributes()->PrimaryNormals())
 		{
 			Normals = Mesh.Attributes()->PrimaryNormals();
-			NumNormals = Normals->ElementCount();
-			for (int32 ni = 0; ni < NumNormals; ++ni)
+			MakeIndexMap(Normals->ElementIndicesItr(), Normals->MaxElementID(), NormalIDs, NormalIndexMap);
+			NumNormals = NormalIDs.Num();
+			const float NormalSign = (bReverseOrientation) ? -1.0f : 1.0f;
+			WriteRecords(NumNormals, [&](FOBJTextBuffer& Buffer, int32 Index)
 			{
-				FVector3f Normal = Normals->GetElement(ni);
-				WriteLine(*FString::Printf(TEXT("vn %f %f %f"), Normal.X, Normal.Y, Normal.Z));
-			}
+				FVector3f Normal = NormalSign * Normals->GetElement(NormalIDs[Index]);
+				Buffer.AppendString("vn ", 3);
+				Buffer.AppendFloat(Normal.X);
+				Buffer.AppendChar(' ');
+				Buffer.AppendFloat(Normal.Y);
+				Buffer.AppendChar(' ');
+				Buffer.AppendFloat(Normal.Z);
+				Buffer.AppendChar('\n');
+			});
 		}
 
 		struct FMeshTri
@@ -64,69 +285,71 @@ public:
 		TSet<int32> AllGroupIDs;
 
 		TArray<FMeshTri> Triangles;
-
-		int32 NumTriangles = Mesh.TriangleCount();
-		for (int32 ti = 0; ti < NumTriangles; ++ti)
+		Triangles.Reserve(Mesh.TriangleCount());
+		int32 MaxGroupID = 0;
+		for (int32 ti : Mesh.TriangleIndicesItr())
 		{
-			if (Mesh.IsTriangle(ti))
-			{
-				int32 GroupID = Mesh.GetTriangleGroup(ti);
-				AllGroupIDs.Add(GroupID);
-				Triangles.Add({ ti, GroupID });
-			}
+			int32 GroupID = Mesh.GetTriangleGroup(ti);
+			AllGroupIDs.Add(GroupID);
+			Triangles.Add({ ti, GroupID });
+			MaxGroupID = FMath::Max(MaxGroupID, GroupID);
 		}
-		bool bHaveGroups = AllGroupIDs.Num() > 1;
+		bool bHaveGroups = bAlwaysWriteGroups || AllGroupIDs.Num() > 1;
 
 		Triangles.StableSort([](const FMeshTri& Tri0, const FMeshTri& Tri1)
 		{
 			return Tri0.Group < Tri1.Group;
 		});
 
-
-		int32 CurGroupID = -99999;
-		for (FMeshTri MeshTri : Triangles)
+		const int32 UseGroupOffset = GroupOffset;
+		const FIndex3i Offsets = IndexOffsets;
+		WriteRecords(Triangles.Num(), [&](FOBJTextBuffer& Buffer, int32 Index)
 		{
-			if (bHaveGroups && MeshTri.Group != CurGroupID)
+			const FMeshTri& MeshTri = Triangles[Index];
+			if (bHaveGroups && (Index == 0 || Triangles[Index - 1].Group != MeshTri.Group))
 			{
-				WriteLine(*FString::Printf(TEXT("g %d"), MeshTri.Group));
-				CurGroupID = MeshTri.Group;
+				Buffer.AppendString("g ", 2);
+				Buffer.AppendInt(UseGroupOffset + MeshTri.Group);
+				Buffer.AppendChar('\n');
 			}
 
 			int32 ti = MeshTri.Index;
-
 			FIndex3i TriVertices = Mesh.GetTriangle(ti);
-			FIndex3i TriUVs = (NumUVs > 0) ? UVs->GetTriangle(ti) : FIndex3i::Invalid();
-			FIndex3i TriNormals = (NumNormals > 0) ? Normals->GetTriangle(ti) : FIndex3i::Invalid();
-
 			bool bHaveUV = (NumUVs != 0) && UVs->IsSetTriangle(ti);
 			bool bHaveNormal = (NumNormals != 0) && Normals->IsSetTriangle(ti);
-
-			if (bHaveUV && bHaveNormal)
-			{
-				WriteLine(*FString::Printf(TEXT("f %d/%d/%d %d/%d/%d %d/%d/%d"),
-					TriVertices.A + 1, TriUVs.A + 1, TriNormals.A + 1,
-					TriVertices.B + 1, TriUVs.B + 1, TriNormals.B + 1,
-					TriVertices.C + 1, TriUVs.C + 1, TriNormals.C + 1));
-			}
-			else if (bHaveUV)
-			{
-				WriteLine(*FString::Printf(TEXT("f %d/%d %d/%d %d/%d"),
-					TriVertices.A + 1, TriUVs.A + 1, TriVertices.B + 1, TriUVs.B + 1, TriVertices.C + 1, TriUVs.C + 1));
-			}
-			else if (bHaveNormal)
+			FIndex3i TriUVs = (bHaveUV) ? UVs->GetTriangle(ti) : FIndex3i::Invalid();
+			FIndex3i TriNormals = (bHaveNormal) ? Normals->GetTriangle(ti) : FIndex3i::Invalid();
+			if (bReverseOrientation)
 			{
-				WriteLine(*FString::Printf(TEXT("f %d//%d %d//%d %d//%d"),
-					TriVertices.A + 1, TriNormals.A + 1, TriVertices.B + 1, TriNormals.B + 1, TriVertices.C + 1, TriNormals.C + 1));
+				Swap(TriVertices.B, TriVertices.C);
+				Swap(TriUVs.B, TriUVs.C);
+				Swap(TriNormals.B, TriNormals.C);
 			}
-			else
+
+			Buffer.AppendChar('f');
+			for (int32 j = 0; j < 3; ++j)
 			{
-				WriteLine(*FString::Printf(TEXT("f %d %d %d"), TriVertices.A + 1, TriVertices.B + 1, TriVertices.C + 1));
+				Buffer.AppendChar(' ');
+				Buffer.AppendInt(Offsets.A + MapIndex(VertexIndexMap, TriVertices[j]) + 1);
+				if (bHaveUV || bHaveNormal)
+				{
+					Buffer.AppendChar('/');
+					if (bHaveUV)
+					{
+						Buffer.AppendInt(Offsets.B + MapIndex(UVIndexMap, TriUVs[j]) + 1);
+					}
+					if (bHaveNormal)
+					{
+						Buffer.AppendChar('/');
+						Buffer.AppendInt(Offsets.C + MapIndex(NormalIndexMap, TriNormals[j]) + 1);
+					}
+				}
 			}
-		}
-
-		CloseFile();
+			Buffer.AppendChar('\n');
+		});
 
-		return true;
+		IndexOffsets += FIndex3i(VertexIDs.Num(), NumUVs, NumNormals);
+		GroupOffset += MaxGroupID + 1;
 	}
 };
 
@@ -137,55 +360,67 @@ bool RTGUtils::WriteOBJMesh(
 	const FDynamicMesh3& Mesh,
 	bool bReverseOrientation)
 {
+	FDynamicMeshOBJWriter Writer;
 	const FDynamicMesh3* WriteMesh = &Mesh;
+	return Writer.Write(OutputPath, MakeArrayView(&WriteMesh, 1), bReverseOrientation);
+}
+
 
-	FDynamicMesh3 CopyMesh;
-	if (bReverseOrientation)
+
+bool RTGUtils::WriteOBJMeshes(
+	const FString& OutputPath,
+	const TArray<FDynamicMesh3>& Meshes,
+	bool bReverseOrientation)
+{
+	TArray<const FDynamicMesh3*> WriteMeshes;
+	for (const FDynamicMesh3& Mesh : Meshes)
 	{
-		CopyMesh = Mesh;
-		CopyMesh.ReverseOrientation();
-		WriteMesh = &CopyMesh;
+		WriteMeshes.Add(&Mesh);
 	}
 
 	FDynamicMeshOBJWriter Writer;
-	std::string OutputFilePath(TCHAR_TO_UTF8(*OutputPath));
-	return Writer.Write(OutputFilePath.c_str(), *WriteMesh);
+	return Writer.Write(OutputPath, WriteMeshes, bReverseOrientation);
 }
 
 
 
-bool RTGUtils::WriteOBJMeshes(
+void RTGUtils::WriteOBJMeshesAsync(
 	const FString& OutputPath,
-	const TArray<FDynamicMesh3>& Meshes,
-	bool bReverseOrientation)
+	TArray<TSharedPtr<const FDynamicMesh3, ESPMode::ThreadSafe>> Meshes,
+	bool bReverseOrientation,
+	TFunction<void(float)> OnProgress,
+	TFunction<void(bool)> OnComplete)
 {
-	FDynamicMesh3 CombinedMesh;
-	FDynamicMeshEditor Editor(&CombinedMesh);
-
-	for (const FDynamicMesh3& Mesh : Meshes)
+	Async(EAsyncExecution::ThreadPool, [OutputPath, Meshes = MoveTemp(Meshes), bReverseOrientation, OnProgress = MoveTemp(OnProgress), OnComplete = MoveTemp(OnComplete)]()
 	{
-		if (Mesh.HasTriangleGroups())
+		TArray<const FDynamicMesh3*> WriteMeshes;
+		for (const TSharedPtr<const FDynamicMesh3, ESPMode::ThreadSafe>& Mesh : Meshes)
 		{
-			CombinedMesh.EnableTriangleGroups();
+			if (Mesh.IsValid())
+			{
+				WriteMeshes.Add(Mesh.Get());
+			}
 		}
-		if (Mesh.HasAttributes())
+
+		FDynamicMeshOBJWriter Writer;
+		if (OnProgress)
 		{
-			CombinedMesh.EnableAttributes();
+			// only forward progress to the game thread in whole-percent steps
+			Writer.ProgressCallback = [OnProgress, LastPercent = -1](float Progress) mutable
+			{
+				int32 Percent = FMath::FloorToInt32(Progress * 100.0f);
+				if (Percent > LastPercent)
+				{
+					LastPercent = Percent;
+					AsyncTask(ENamedThreads::GameThread, [OnProgress, Progress]() { OnProgress(Progress); });
+				}
+			};
 		}
+		bool bOK = Writer.Write(OutputPath, WriteMeshes, bReverseOrientation);
 
-		FMeshIndexMappings Mappings;
-		Editor.AppendMesh(&Mesh, Mappings);
-	}
-
-	if (bReverseOrientation)
-	{
-		CombinedMesh.ReverseOrientation();
-	}
-
-	FDynamicMeshOBJWriter Writer;
-
-	std::string OutputFilePath(TCHAR_TO_UTF8(*OutputPath));
-	return Writer.Write(OutputFilePath.c_str(), CombinedMesh);
+		if (OnComplete)
+		{
+			AsyncTask(ENamedThreads::GameThread, [OnComplete, bOK]() { OnComplete(bOK); });
+		}
+	});
 }
-
-
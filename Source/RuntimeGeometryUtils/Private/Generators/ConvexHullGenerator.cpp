@@ -77,6 +77,7 @@ UE::Geometry::FMeshShapeGenerator& FConvexHullGenerator::Generate()
 	GenerateVertices();
 	TriangulateConvexHull();
 	OutputTriangles();
+	ExtrudeSheet();
 	
 	return *this;
 }
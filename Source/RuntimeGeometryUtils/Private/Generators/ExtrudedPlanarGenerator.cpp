@@ -0,0 +1,108 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../../Public/Generators/ExtrudedPlanarGenerator.h"
+#include "VectorUtil.h"
+
+using namespace UE::Geometry;
+
+
+void FExtrudedPlanarGenerator::ExtrudeSheet()
+{
+	const int32 NumSheetVertices = Vertices.Num();
+	const int32 NumSheetTriangles = Triangles.Num();
+	if (ExtrusionDepth <= 0 || NumSheetTriangles == 0)
+	{
+		return;
+	}
+
+	// 朝向+Z. UE是左手系, VectorUtil::Normal(A,B,C)在XY平面顺时针时为+Z
+	for (int32 i = 0; i < NumSheetTriangles; ++i)
+	{
+		const FIndex3i& Tri = Triangles[i];
+		if (VectorUtil::Normal(Vertices[Tri.A], Vertices[Tri.B], Vertices[Tri.C]).Z < 0)
+		{
+			SetTriangle(i, FIndex3i(Tri.A, Tri.C, Tri.B));
+			SetTriangleUVs(i, FIndex3i(TriangleUVs[i].A, TriangleUVs[i].C, TriangleUVs[i].B));
+			SetTriangleNormals(i, FIndex3i(TriangleNormals[i].A, TriangleNormals[i].C, TriangleNormals[i].B));
+		}
+		SetTrianglePolygon(i, TopPolygonID);
+	}
+
+	// 边界边: 反向边不存在的有向边
+	TSet<FIndex2i> DirectedEdges;
+	DirectedEdges.Reserve(NumSheetTriangles * 3);
+	for (const FIndex3i& Tri : Triangles)
+	{
+		for (int32 j = 0; j < 3; ++j)
+		{
+			DirectedEdges.Add(FIndex2i(Tri[j], Tri[(j + 1) % 3]));
+		}
+	}
+	TArray<FIndex2i> BoundaryEdges;
+	for (const FIndex2i& Edge : DirectedEdges)
+	{
+		if (DirectedEdges.Contains(FIndex2i(Edge.B, Edge.A)) == false)
+		{
+			BoundaryEdges.Add(Edge);
+		}
+	}
+
+	const int32 NumSheetUVs = UVs.Num();
+	const int32 NumSheetNormals = Normals.Num();
+	const int32 NumBoundary = BoundaryEdges.Num();
+	SetBufferSizes(
+		2 * NumSheetVertices,
+		2 * NumSheetTriangles + 2 * NumBoundary,
+		NumSheetUVs + NumSheetVertices + 4 * NumBoundary,
+		NumSheetNormals + NumSheetVertices + 4 * NumBoundary);
+
+	// 底面: 顶点下移, 三角形反向, 法线-Z
+	const FVector3d Offset(0, 0, -ExtrusionDepth);
+	for (int32 i = 0; i < NumSheetVertices; ++i)
+	{
+		const int32 BottomVertex = NumSheetVertices + i;
+		SetVertex(BottomVertex, Vertices[i] + Offset);
+		SetUV(NumSheetUVs + i, FVector2f((float)Vertices[i].X / 1000.0f, (float)Vertices[i].Y / 1000.0f), BottomVertex);
+		SetNormal(NumSheetNormals + i, -FVector3f::UpVector, BottomVertex);
+	}
+	for (int32 i = 0; i < NumSheetTriangles; ++i)
+	{
+		const FIndex3i& Tri = Triangles[i];
+		const FIndex3i BottomTri(Tri.A + NumSheetVertices, Tri.C + NumSheetVertices, Tri.B + NumSheetVertices);
+		const int32 BottomTriangle = NumSheetTriangles + i;
+		SetTriangle(BottomTriangle, BottomTri);
+		SetTriangleUVs(BottomTriangle, FIndex3i(Tri.A + NumSheetUVs, Tri.C + NumSheetUVs, Tri.B + NumSheetUVs));
+		SetTriangleNormals(BottomTriangle, FIndex3i(Tri.A + NumSheetNormals, Tri.C + NumSheetNormals, Tri.B + NumSheetNormals));
+		SetTrianglePolygon(BottomTriangle, BottomPolygonID);
+	}
+
+	// 侧面: 每条边界边(A,B)一个四边形(B,A,A',B'), 与顶面共享顶点, 法线和UV独立以保持硬边
+	const float V1 = (float)ExtrusionDepth / 1000.0f;
+	for (int32 k = 0; k < NumBoundary; ++k)
+	{
+		const int32 A = BoundaryEdges[k].A, B = BoundaryEdges[k].B;
+		const FIndex4i Quad(B, A, A + NumSheetVertices, B + NumSheetVertices);
+		const FVector3f SideNormal = (FVector3f)VectorUtil::Normal(Vertices[Quad.A], Vertices[Quad.B], Vertices[Quad.C]);
+		const float U1 = (float)Distance(Vertices[A], Vertices[B]) / 1000.0f;
+		const FVector2f QuadUVs[4] = { FVector2f(0, 0), FVector2f(U1, 0), FVector2f(U1, V1), FVector2f(0, V1) };
+
+		const int32 UVBase = NumSheetUVs + NumSheetVertices + 4 * k;
+		const int32 NormalBase = NumSheetNormals + NumSheetVertices + 4 * k;
+		for (int32 j = 0; j < 4; ++j)
+		{
+			SetUV(UVBase + j, QuadUVs[j], Quad[j]);
+			SetNormal(NormalBase + j, SideNormal, Quad[j]);
+		}
+
+		const int32 SideTriangle = 2 * NumSheetTriangles + 2 * k;
+		SetTriangle(SideTriangle, FIndex3i(Quad.A, Quad.B, Quad.C));
+		SetTriangleUVs(SideTriangle, FIndex3i(UVBase, UVBase + 1, UVBase + 2));
+		SetTriangleNormals(SideTriangle, FIndex3i(NormalBase, NormalBase + 1, NormalBase + 2));
+		SetTrianglePolygon(SideTriangle, SidePolygonID);
+		SetTriangle(SideTriangle + 1, FIndex3i(Quad.A, Quad.C, Quad.D));
+		SetTriangleUVs(SideTriangle + 1, FIndex3i(UVBase, UVBase + 2, UVBase + 3));
+		SetTriangleNormals(SideTriangle + 1, FIndex3i(NormalBase, NormalBase + 2, NormalBase + 3));
+		SetTrianglePolygon(SideTriangle + 1, SidePolygonID);
+	}
+}
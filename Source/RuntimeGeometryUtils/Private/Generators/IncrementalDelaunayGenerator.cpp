@@ -0,0 +1,285 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../../Public/Generators/IncrementalDelaunayGenerator.h"
+#include "../../Public/Generators/ExtrudedPlanarGenerator.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+
+using namespace UE::Geometry;
+
+namespace IncrementalDelaunayGeneratorLocal
+{
+	/** Copies the output triangles of a triangulation into the shape generator buffers and extrudes them */
+	class FTriangulationExtruder : public FExtrudedPlanarGenerator
+	{
+	public:
+		const FIncrementalDelaunay2* Triangulation = nullptr;
+		double Height = 0;
+
+		virtual FMeshShapeGenerator& Generate() override
+		{
+			TArray<int32> VertexMap;
+			VertexMap.Init(-1, Triangulation->MaxVertexID());
+			TArray<FIndex3i> SheetTriangles;
+			TArray<int32> SheetVertices;
+			for (int32 tid = 0; tid < Triangulation->MaxTriangleID(); ++tid)
+			{
+				if (Triangulation->IsOutputTriangle(tid) == false)
+				{
+					continue;
+				}
+				const FIndex3i& Tri = Triangulation->GetTriangle(tid);
+				FIndex3i SheetTri;
+				for (int32 j = 0; j < 3; ++j)
+				{
+					if (VertexMap[Tri[j]] < 0)
+					{
+						VertexMap[Tri[j]] = SheetVertices.Add(Tri[j]);
+					}
+					SheetTri[j] = VertexMap[Tri[j]];
+				}
+				SheetTriangles.Add(SheetTri);
+			}
+			if (SheetTriangles.Num() == 0)
+			{
+				return *this;
+			}
+
+			SetBufferSizes(SheetVertices.Num(), SheetTriangles.Num(), SheetVertices.Num(), SheetVertices.Num());
+			for (int32 i = 0; i < SheetVertices.Num(); ++i)
+			{
+				const FVector2f& Position = Triangulation->GetVertex(SheetVertices[i]);
+				SetVertex(i, FVector3d(Position.X, Position.Y, Height));
+				SetUV(i, FVector2f(Position.X / 1000.0f, Position.Y / 1000.0f), i);
+				SetNormal(i, FVector3f::UpVector, i);
+			}
+			for (int32 i = 0; i < SheetTriangles.Num(); ++i)
+			{
+				SetTriangle(i, SheetTriangles[i]);
+				SetTriangleUVs(i, SheetTriangles[i]);
+				SetTriangleNormals(i, SheetTriangles[i]);
+				SetTrianglePolygon(i, TopPolygonID);
+			}
+			ExtrudeSheet();
+			return *this;
+		}
+	};
+}
+
+
+void FIncrementalDelaunayGenerator::RemoveTriangulationVertex(int32 VertexID)
+{
+	if (VertexID < 0)
+	{
+		return;
+	}
+	Triangulation.RemoveVertex(VertexID);
+
+	// the vertex ID may be reused by the next insertion, so its mesh vertex is detached now
+	if (Triangulation.IsVertex(VertexID) == false && VertexID < VertexToMeshVertex.Num() && VertexToMeshVertex[VertexID] >= 0)
+	{
+		RemovedMeshVertices.Add(VertexToMeshVertex[VertexID]);
+		VertexToMeshVertex[VertexID] = -1;
+	}
+}
+
+
+void FIncrementalDelaunayGenerator::SetInput(const TArray<FVector2f>& Points, const TArray<FIntPoint>& Constraints)
+{
+	const int32 NumKept = FMath::Min(Points.Num(), CurrentPoints.Num());
+
+	// constraints are re-inserted if they changed or if one of their points moved or was removed
+	TArray<bool> PointChanged;
+	PointChanged.Init(true, CurrentPoints.Num());
+	for (int32 i = 0; i < NumKept; ++i)
+	{
+		PointChanged[i] = Points[i] != CurrentPoints[i];
+	}
+	bool bConstraintsChanged = (Constraints != CurrentConstraints);
+	for (const FIntPoint& Constraint : CurrentConstraints)
+	{
+		bConstraintsChanged = bConstraintsChanged
+			|| (PointChanged.IsValidIndex(Constraint.X) && PointChanged[Constraint.X])
+			|| (PointChanged.IsValidIndex(Constraint.Y) && PointChanged[Constraint.Y]);
+	}
+
+	if (bConstraintsChanged)
+	{
+		for (const FIntPoint& Constraint : CurrentConstraints)
+		{
+			if (PointVertexIDs.IsValidIndex(Constraint.X) && PointVertexIDs.IsValidIndex(Constraint.Y))
+			{
+				Triangulation.RemoveConstraint(PointVertexIDs[Constraint.X], PointVertexIDs[Constraint.Y]);
+			}
+		}
+	}
+
+	// moved and removed points
+	for (int32 i = 0; i < CurrentPoints.Num(); ++i)
+	{
+		if (PointChanged[i])
+		{
+			RemoveTriangulationVertex(PointVertexIDs[i]);
+			PointVertexIDs[i] = -1;
+		}
+	}
+	PointVertexIDs.SetNum(Points.Num());
+
+	// moved and added points
+	for (int32 i = 0; i < Points.Num(); ++i)
+	{
+		if (i >= NumKept || PointChanged[i])
+		{
+			PointVertexIDs[i] = Triangulation.InsertVertex(Points[i]);
+		}
+	}
+
+	if (bConstraintsChanged)
+	{
+		for (const FIntPoint& Constraint : Constraints)
+		{
+			if (PointVertexIDs.IsValidIndex(Constraint.X) && PointVertexIDs.IsValidIndex(Constraint.Y)
+				&& PointVertexIDs[Constraint.X] >= 0 && PointVertexIDs[Constraint.Y] >= 0)
+			{
+				Triangulation.InsertConstraint(PointVertexIDs[Constraint.X], PointVertexIDs[Constraint.Y]);
+			}
+		}
+	}
+
+	CurrentPoints = Points;
+	CurrentConstraints = Constraints;
+}
+
+
+int32 FIncrementalDelaunayGenerator::GetOrAddMeshVertex(FDynamicMesh3& Mesh, int32 VertexID)
+{
+	while (VertexToMeshVertex.Num() <= VertexID)
+	{
+		VertexToMeshVertex.Add(-1);
+		VertexUVElements.Add(-1);
+		VertexNormalElements.Add(-1);
+	}
+	if (VertexToMeshVertex[VertexID] < 0)
+	{
+		const FVector2f& Position = Triangulation.GetVertex(VertexID);
+		VertexToMeshVertex[VertexID] = Mesh.AppendVertex(FVector3d(Position.X, Position.Y, Height));
+	}
+	return VertexToMeshVertex[VertexID];
+}
+
+
+int32 FIncrementalDelaunayGenerator::UpdateMesh(FDynamicMesh3& Mesh, bool bFullRebuild)
+{
+	TArray<int32> ChangedTriangles;
+	Triangulation.UpdateOutputTriangles(ChangedTriangles);
+
+	if (ExtrusionDepth > 0)
+	{
+		IncrementalDelaunayGeneratorLocal::FTriangulationExtruder Extruder;
+		Extruder.Triangulation = &Triangulation;
+		Extruder.Height = Height;
+		Extruder.ExtrusionDepth = ExtrusionDepth;
+		Mesh.Copy(&Extruder.Generate());
+		bMeshIsExtruded = true;
+		return Mesh.TriangleCount();
+	}
+
+	// the triangle mapping is only valid for a sheet written by the last update
+	bFullRebuild = bFullRebuild || bMeshIsExtruded;
+	bMeshIsExtruded = false;
+
+	if (bFullRebuild)
+	{
+		Mesh = FDynamicMesh3();
+		Mesh.EnableTriangleGroups();
+		Mesh.EnableAttributes();
+		VertexToMeshVertex.Init(-1, Triangulation.MaxVertexID());
+		VertexUVElements.Init(-1, Triangulation.MaxVertexID());
+		VertexNormalElements.Init(-1, Triangulation.MaxVertexID());
+		TriangleToMeshTriangle.Init(-1, Triangulation.MaxTriangleID());
+		RemovedMeshVertices.Reset();
+
+		ChangedTriangles.Reset();
+		for (int32 tid = 0; tid < Triangulation.MaxTriangleID(); ++tid)
+		{
+			if (Triangulation.IsOutputTriangle(tid))
+			{
+				ChangedTriangles.Add(tid);
+			}
+		}
+	}
+
+	FDynamicMeshUVOverlay* UVOverlay = Mesh.Attributes()->PrimaryUV();
+	FDynamicMeshNormalOverlay* NormalOverlay = Mesh.Attributes()->PrimaryNormals();
+
+	// overlay elements are freed with their last triangle, so the cached per-vertex elements are validated before reuse
+	auto GetElement = [&Mesh](auto* Overlay, TArray<int32>& VertexElements, int32 VertexID, int32 MeshVertexID, auto Value)
+	{
+		int32& ElementID = VertexElements[VertexID];
+		if (ElementID < 0 || Overlay->IsElement(ElementID) == false || Overlay->GetParentVertex(ElementID) != MeshVertexID)
+		{
+			ElementID = Overlay->AppendElement(Value);
+		}
+		return ElementID;
+	};
+
+	while (TriangleToMeshTriangle.Num() < Triangulation.MaxTriangleID())
+	{
+		TriangleToMeshTriangle.Add(-1);
+	}
+	int32 NumUpdated = 0;
+	for (int32 tid : ChangedTriangles)
+	{
+		if (TriangleToMeshTriangle.IsValidIndex(tid) == false)
+		{
+			continue;
+		}
+		int32& MeshTriangle = TriangleToMeshTriangle[tid];
+		if (MeshTriangle >= 0 && Mesh.IsTriangle(MeshTriangle))
+		{
+			Mesh.RemoveTriangle(MeshTriangle, false);
+			NumUpdated++;
+		}
+		MeshTriangle = -1;
+	}
+
+	for (int32 MeshVertex : RemovedMeshVertices)
+	{
+		if (Mesh.IsVertex(MeshVertex))
+		{
+			Mesh.RemoveVertex(MeshVertex);
+		}
+	}
+	RemovedMeshVertices.Reset();
+
+	for (int32 tid : ChangedTriangles)
+	{
+		if (Triangulation.IsOutputTriangle(tid) == false)
+		{
+			continue;
+		}
+
+		// triangulation triangles are counter-clockwise in XY, reversed for an upward facing mesh (UE normals are left-handed)
+		const FIndex3i& Tri = Triangulation.GetTriangle(tid);
+		const FIndex3i Corners(Tri.C, Tri.B, Tri.A);
+		FIndex3i MeshTri, UVTri, NormalTri;
+		for (int32 j = 0; j < 3; ++j)
+		{
+			MeshTri[j] = GetOrAddMeshVertex(Mesh, Corners[j]);
+			const FVector2f& Position = Triangulation.GetVertex(Corners[j]);
+			UVTri[j] = GetElement(UVOverlay, VertexUVElements, Corners[j], MeshTri[j], FVector2f(Position.X / 1000.0f, Position.Y / 1000.0f));
+			NormalTri[j] = GetElement(NormalOverlay, VertexNormalElements, Corners[j], MeshTri[j], FVector3f::UpVector);
+		}
+
+		const int32 MeshTriangle = Mesh.AppendTriangle(MeshTri, 0);
+		if (MeshTriangle >= 0)
+		{
+			UVOverlay->SetTriangle(MeshTriangle, UVTri);
+			NormalOverlay->SetTriangle(MeshTriangle, NormalTri);
+			TriangleToMeshTriangle[tid] = MeshTriangle;
+			NumUpdated++;
+		}
+	}
+
+	return NumUpdated;
+}
@@ -6,6 +6,97 @@
 #include "CompGeom/ConvexHull2.h"
 #include "CompGeom/PolygonTriangulation.h"
 #include "../../Public/Algorithms/PointTriangleRelation.h"
+#include "BoxTypes.h"
+#include "Math/RandomStream.h"
+#include "HAL/IConsoleManager.h"
+
+namespace RandomPointsMeshGeneratorLocal
+{
+	// replace OldNeighbor by NewNeighbor in the adjacency of Triangle
+	static void ReplaceNeighbor(TArray<UE::Geometry::FIndex3i>& Neighbors, int32 Triangle, int32 OldNeighbor, int32 NewNeighbor)
+	{
+		if (Triangle >= 0)
+		{
+			UE::Geometry::FIndex3i& TriNbrs = Neighbors[Triangle];
+			for (int32 e = 0; e < 3; ++e)
+			{
+				if (TriNbrs[e] == OldNeighbor)
+				{
+					TriNbrs[e] = NewNeighbor;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Uniform grid over the hull, each cell lists the triangles that overlap it. Split triangles are never removed,
+	 * as the triangles replacing them lie inside them, so a cell may list triangles that no longer overlap it and
+	 * candidates have to be tested. Location does not depend on the triangle shapes, unlike a walk.
+	 */
+	struct FTriangleGrid
+	{
+		FVector2f Origin;
+		FVector2f CellSize;
+		int32 NumX = 1, NumY = 1;
+		TArray<TArray<int32>> Cells;
+
+		void Initialize(const UE::Geometry::FAxisAlignedBox2f& Bounds, int32 NumPoints)
+		{
+			// about 4 points per cell, fewer cells keep the number of cells overlapped by long thin triangles down
+			NumX = NumY = FMath::Clamp((int32)FMath::Sqrt((float)NumPoints) / 2, 1, 1024);
+			Origin = Bounds.Min;
+			CellSize = FVector2f(FMath::Max(Bounds.Width(), FMathf::ZeroTolerance) / NumX, FMath::Max(Bounds.Height(), FMathf::ZeroTolerance) / NumY);
+			Cells.SetNum(NumX * NumY);
+		}
+
+		int32 CellX(float X) const { return FMath::Clamp(FMath::FloorToInt32((X - Origin.X) / CellSize.X), 0, NumX - 1); }
+		int32 CellY(float Y) const { return FMath::Clamp(FMath::FloorToInt32((Y - Origin.Y) / CellSize.Y), 0, NumY - 1); }
+
+		const TArray<int32>& GetCell(const FVector2f& Point) const { return Cells[CellY(Point.Y) * NumX + CellX(Point.X)]; }
+
+		/** Add Triangle to the cells it overlaps, by clipping it to each row of cells. Slightly conservative */
+		void Insert(int32 Triangle, const FVector2f& A, const FVector2f& B, const FVector2f& C)
+		{
+			const FVector2f Corners[3] = { A, B, C };
+			const float Tolerance = 1e-4f * FMath::Max(CellSize.X, CellSize.Y);
+			const int32 MinRow = CellY(FMath::Min3(A.Y, B.Y, C.Y) - Tolerance), MaxRow = CellY(FMath::Max3(A.Y, B.Y, C.Y) + Tolerance);
+			for (int32 Row = MinRow; Row <= MaxRow; ++Row)
+			{
+				const float Y0 = Origin.Y + Row * CellSize.Y - Tolerance, Y1 = Origin.Y + (Row + 1) * CellSize.Y + Tolerance;
+				float MinX = TNumericLimits<float>::Max(), MaxX = -TNumericLimits<float>::Max();
+				for (int32 e = 0; e < 3; ++e)
+				{
+					const FVector2f& P = Corners[e];
+					const FVector2f& Q = Corners[(e + 1) % 3];
+					if (P.Y >= Y0 && P.Y <= Y1)
+					{
+						MinX = FMath::Min(MinX, P.X);
+						MaxX = FMath::Max(MaxX, P.X);
+					}
+					if (P.Y != Q.Y)
+					{
+						for (float Y : { Y0, Y1 })
+						{
+							if ((Y - P.Y) * (Y - Q.Y) <= 0)
+							{
+								const float X = P.X + (Y - P.Y) * (Q.X - P.X) / (Q.Y - P.Y);
+								MinX = FMath::Min(MinX, X);
+								MaxX = FMath::Max(MaxX, X);
+							}
+						}
+					}
+				}
+				if (MinX <= MaxX)
+				{
+					for (int32 Column = CellX(MinX - Tolerance), MaxColumn = CellX(MaxX + Tolerance); Column <= MaxColumn; ++Column)
+					{
+						Cells[Row * NumX + Column].Add(Triangle);
+					}
+				}
+			}
+		}
+	};
+}
 
 bool FRandomPointsMeshGenerator::GenerateVertices()
 {	
@@ -53,8 +144,87 @@ bool FRandomPointsMeshGenerator::GenerateVertices()
 	return true;
 }
 
+void FRandomPointsMeshGenerator::BuildTriangleNeighbors()
+{
+	TMap<uint64, int32> EdgeToTriangleEdge;
+	TriangleNeighbors2D.Init(UE::Geometry::FIndex3i(-1, -1, -1), Triangles2D.Num());
+	for (int32 t = 0; t < Triangles2D.Num(); ++t)
+	{
+		for (int32 e = 0; e < 3; ++e)
+		{
+			int32 A = Triangles2D[t][e], B = Triangles2D[t][(e + 1) % 3];
+			uint64 Key = ((uint64)FMath::Min(A, B) << 32) | (uint64)FMath::Max(A, B);
+			if (const int32* Other = EdgeToTriangleEdge.Find(Key))
+			{
+				TriangleNeighbors2D[t][e] = *Other / 3;
+				TriangleNeighbors2D[*Other / 3][*Other % 3] = t;
+			}
+			else
+			{
+				EdgeToTriangleEdge.Add(Key, t * 3 + e);
+			}
+		}
+	}
+}
+
+void FRandomPointsMeshGenerator::SplitTriangle(int32 TriangleIndex, int32 VertexIndex)
+{
+	using namespace RandomPointsMeshGeneratorLocal;
+
+	// (A,B,C) -> (A,B,P) in place, (B,C,P) and (C,A,P) appended
+	const UE::Geometry::FIndex3i Tri = Triangles2D[TriangleIndex];
+	const UE::Geometry::FIndex3i Nbrs = TriangleNeighbors2D[TriangleIndex];
+	const int32 T1 = Triangles2D.Num(), T2 = T1 + 1;
+
+	Triangles2D[TriangleIndex] = UE::Geometry::FIndex3i(Tri.A, Tri.B, VertexIndex);
+	Triangles2D.Add(UE::Geometry::FIndex3i(Tri.B, Tri.C, VertexIndex));
+	Triangles2D.Add(UE::Geometry::FIndex3i(Tri.C, Tri.A, VertexIndex));
+
+	TriangleNeighbors2D[TriangleIndex] = UE::Geometry::FIndex3i(Nbrs.A, T1, T2);
+	TriangleNeighbors2D.Add(UE::Geometry::FIndex3i(Nbrs.B, T2, TriangleIndex));
+	TriangleNeighbors2D.Add(UE::Geometry::FIndex3i(Nbrs.C, TriangleIndex, T1));
+
+	// the outer neighbors of edges BC and CA now border the new triangles
+	ReplaceNeighbor(TriangleNeighbors2D, Nbrs.B, TriangleIndex, T1);
+	ReplaceNeighbor(TriangleNeighbors2D, Nbrs.C, TriangleIndex, T2);
+}
+
+void FRandomPointsMeshGenerator::SplitEdge(int32 TriangleIndex, int32 Edge, int32 VertexIndex)
+{
+	using namespace RandomPointsMeshGeneratorLocal;
+
+	// T = (A,B,C) -> (P,B,C) in place and (A,P,C) appended; the neighbor M = (B,A,D) -> (P,A,D) in place and (B,P,D) appended
+	const int32 T = TriangleIndex;
+	const int32 A = Triangles2D[T][Edge], B = Triangles2D[T][(Edge + 1) % 3], C = Triangles2D[T][(Edge + 2) % 3];
+	const int32 TNbrBC = TriangleNeighbors2D[T][(Edge + 1) % 3], TNbrCA = TriangleNeighbors2D[T][(Edge + 2) % 3];
+	const int32 M = TriangleNeighbors2D[T][Edge];
+	const int32 T1 = Triangles2D.Num();
+	const int32 M1 = (M >= 0) ? T1 + 1 : -1;
+
+	Triangles2D[T] = UE::Geometry::FIndex3i(VertexIndex, B, C);
+	TriangleNeighbors2D[T] = UE::Geometry::FIndex3i(M1, TNbrBC, T1);
+	Triangles2D.Add(UE::Geometry::FIndex3i(A, VertexIndex, C));
+	TriangleNeighbors2D.Add(UE::Geometry::FIndex3i(M, T, TNbrCA));
+	ReplaceNeighbor(TriangleNeighbors2D, TNbrCA, T, T1);
+
+	if (M >= 0)
+	{
+		const int32 f = (Triangles2D[M].A == B) ? 0 : (Triangles2D[M].B == B) ? 1 : 2;
+		const int32 D = Triangles2D[M][(f + 2) % 3];
+		const int32 MNbrAD = TriangleNeighbors2D[M][(f + 1) % 3], MNbrDB = TriangleNeighbors2D[M][(f + 2) % 3];
+
+		Triangles2D[M] = UE::Geometry::FIndex3i(VertexIndex, A, D);
+		TriangleNeighbors2D[M] = UE::Geometry::FIndex3i(T1, MNbrAD, M1);
+		Triangles2D.Add(UE::Geometry::FIndex3i(B, VertexIndex, D));
+		TriangleNeighbors2D.Add(UE::Geometry::FIndex3i(T, M, MNbrDB));
+		ReplaceNeighbor(TriangleNeighbors2D, MNbrDB, M, M1);
+	}
+}
+
 void FRandomPointsMeshGenerator::Triangulate()
 {
+	using namespace RandomPointsMeshGeneratorLocal;
+
 	// 注意这里Triangles中的索引是ConvexHullVertices中的索引，不是InputVertices的索引
 	PolygonTriangulation::TriangulateSimplePolygon(ConvexHullVertices,Triangles2D);
 	
@@ -65,29 +235,84 @@ void FRandomPointsMeshGenerator::Triangulate()
 		Triangles2D[i].B = ConvexHullIndices[Triangles2D[i].B];
 		Triangles2D[i].C = ConvexHullIndices[Triangles2D[i].C];
 	}
+	if (Triangles2D.Num() == 0)
+	{
+		return;
+	}
+
+	BuildTriangleNeighbors();
+
+	// 跳过ConvexHull点
+	TArray<bool> IsHullVertex;
+	IsHullVertex.Init(false, VertexCount);
+	for (int32 HullIndex : ConvexHullIndices)
+	{
+		IsHullVertex[HullIndex] = true;
+	}
+
+	UE::Geometry::FAxisAlignedBox2f Bounds = UE::Geometry::FAxisAlignedBox2f::Empty();
+	for (const FVector2f& Point : ConvexHullVertices)
+	{
+		Bounds.Contain(Point);
+	}
+	FTriangleGrid Grid;
+	Grid.Initialize(Bounds, VertexCount);
+	auto InsertTriangle = [this, &Grid](int32 Triangle)
+	{
+		const UE::Geometry::FIndex3i& Tri = Triangles2D[Triangle];
+		Grid.Insert(Triangle, InputVertices[Tri.A], InputVertices[Tri.B], InputVertices[Tri.C]);
+	};
+	for (int32 j = 0; j < Triangles2D.Num(); ++j)
+	{
+		InsertTriangle(j);
+	}
 
-	for(int i = 0 ; i< VertexCount; ++i)
+	// Points are inserted in index order, each splits the triangle containing it, so the result only depends on the
+	// point order. The grid only speeds up finding that triangle.
+	Triangles2D.Reserve(Triangles2D.Num() + 2 * VertexCount);
+	TriangleNeighbors2D.Reserve(Triangles2D.Num() + 2 * VertexCount);
+	for (int32 i = 0; i < VertexCount; ++i)
 	{
-		// 如果是ConvexHull点则跳过
-		if(ConvexHullIndices.Contains(i))
+		if (IsHullVertex[i])
+		{
 			continue;
+		}
 
-		for(int j = 0 ; j< Triangles2D.Num(); ++j)
-		{			
-			// 在三角形内部
-			if(PointTriangleRelation::IsPointInTriangle2D(InputVertices[i],InputVertices[Triangles2D[j].A],InputVertices[Triangles2D[j].B], InputVertices[Triangles2D[j].C]))
+		// 在三角形内部或边上. Recently split triangles are the smallest, so the cell is searched from the back
+		int32 j = -1;
+		int32 EdgeOrVertex = -1;
+		EPointTriangleLocation Location = EPointTriangleLocation::Outside;
+		const TArray<int32>& Candidates = Grid.GetCell(InputVertices[i]);
+		for (int32 k = Candidates.Num() - 1; k >= 0 && j < 0; --k)
+		{
+			const UE::Geometry::FIndex3i& Tri = Triangles2D[Candidates[k]];
+			Location = PointTriangleRelation::ClassifyPointInTriangle2D(InputVertices[i],
+				InputVertices[Tri.A], InputVertices[Tri.B], InputVertices[Tri.C], EdgeOrVertex);
+			j = (Location != EPointTriangleLocation::Outside) ? Candidates[k] : -1;
+		}
+		if (j < 0)
+		{
+			// the cell lists every triangle overlapping it, up to float precision of the clipping
+			j = PointTriangleRelation::FindTriangleContainingPoint2D(InputVertices[i], InputVertices, Triangles2D, Location, EdgeOrVertex);
+		}
+
+		// Points on edges split the edge, duplicate points are skipped
+		if (j >= 0 && Location == EPointTriangleLocation::Inside)
+		{
+			// 创建三个新三角形
+			SplitTriangle(j, i);
+			InsertTriangle(Triangles2D.Num() - 2);
+			InsertTriangle(Triangles2D.Num() - 1);
+		}
+		else if (j >= 0 && Location == EPointTriangleLocation::OnEdge)
+		{
+			const int32 M = TriangleNeighbors2D[j][EdgeOrVertex];
+			const int32 T1 = Triangles2D.Num();
+			SplitEdge(j, EdgeOrVertex, i);
+			InsertTriangle(T1);
+			if (M >= 0)
 			{
-				// 创建三个新三角形
-				UE::Geometry::FIndex3i Tri1(Triangles2D[j].A, Triangles2D[j].B, i);
-				UE::Geometry::FIndex3i Tri2(Triangles2D[j].B, Triangles2D[j].C, i);
-				UE::Geometry::FIndex3i Tri3(Triangles2D[j].C, Triangles2D[j].A,i);
-
-				// ConvexHullTriangles中移除当前这个三角形
-				Triangles2D.RemoveAt(j);
-				Triangles2D.Add(Tri1);
-				Triangles2D.Add(Tri2);
-				Triangles2D.Add(Tri3);
-				break;
+				InsertTriangle(T1 + 1);
 			}
 		}
 	}
@@ -114,6 +339,35 @@ UE::Geometry::FMeshShapeGenerator& FRandomPointsMeshGenerator::Generate()
 	if(GenerateVertices())
 	{
 		Triangulate();
+		ExtrudeSheet();
 	}
 	return *this;
 }
+
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommand RandomPointsTriangulationBenchmarkCommand(
+	TEXT("RTG.BenchmarkRandomPointsTriangulation"),
+	TEXT("Triangulate 1k, 10k and 100k uniform random points with FRandomPointsMeshGenerator and log the timings"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FRandomStream Random(31337);
+		for (int32 NumPoints : { 1000, 10000, 100000 })
+		{
+			FRandomPointsMeshGenerator Generator;
+			Generator.InputVertices.SetNum(NumPoints);
+			for (FVector2f& Point : Generator.InputVertices)
+			{
+				Point = FVector2f(Random.FRandRange(-1000.0f, 1000.0f), Random.FRandRange(-1000.0f, 1000.0f));
+			}
+
+			auto Start = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+			Generator.Generate();
+			auto End = FDateTime::Now().GetTimeOfDay().GetTotalMilliseconds();
+
+			UE_LOG(LogTemp, Display, TEXT("RandomPoints triangulation: %d points, %d triangles, %f ms"), NumPoints, Generator.Triangles.Num(), End - Start);
+		}
+	}));
+
+#endif
@@ -0,0 +1,452 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../../Public/Generators/TiledMarchingCubesGenerator.h"
+#include "Async/ParallelFor.h"
+
+using namespace UE::Geometry;
+
+namespace TiledMarchingCubesGeneratorLocal
+{
+	/**
+	 * Marching cubes case table, built from the face rule instead of the classic table: on each cube face every run of
+	 * inside corners is cut off by one segment between the edge crossings around it. The rule only depends on the signs
+	 * of the face corners, so the two cells sharing a face always agree and the surface has no cracks. The segments of
+	 * the six faces chain into loops, which are triangulated as fans.
+	 * Corner c is at offset (c & 1, (c >> 1) & 1, (c >> 2) & 1).
+	 */
+	struct FCubeTables
+	{
+		int32 EdgeCorners[12][2];		// lower corner first
+		int32 EdgeAxis[12];
+		TArray<FIndex3i> CaseTriangles[256];	// triangles as edge indices
+
+		FCubeTables()
+		{
+			int32 EdgeOfCorners[8][8];
+			int32 NumEdges = 0;
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				for (int32 c = 0; c < 8; ++c)
+				{
+					if ((c & (1 << Axis)) == 0)
+					{
+						const int32 c1 = c | (1 << Axis);
+						EdgeCorners[NumEdges][0] = c;
+						EdgeCorners[NumEdges][1] = c1;
+						EdgeAxis[NumEdges] = Axis;
+						EdgeOfCorners[c][c1] = EdgeOfCorners[c1][c] = NumEdges;
+						NumEdges++;
+					}
+				}
+			}
+
+			// face corners, counter-clockwise seen from outside the cube
+			int32 FaceCorners[6][4];
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				const int32 U = 1 << ((Axis + 1) % 3), V = 1 << ((Axis + 2) % 3);
+				for (int32 Side = 0; Side < 2; ++Side)
+				{
+					const int32 Base = Side << Axis;
+					const int32 Cycle[4] = { Base, Base | U, Base | U | V, Base | V };
+					for (int32 i = 0; i < 4; ++i)
+					{
+						FaceCorners[2 * Axis + Side][i] = Cycle[Side == 1 ? i : 3 - i];
+					}
+				}
+			}
+
+			for (int32 Case = 1; Case < 255; ++Case)
+			{
+				auto IsInside = [Case](int32 Corner) { return (Case & (1 << Corner)) != 0; };
+
+				// NextEdge[e] is the crossing that follows crossing e on the surface loop
+				int32 NextEdge[12];
+				for (int32 e = 0; e < 12; ++e)
+				{
+					NextEdge[e] = -1;
+				}
+				for (int32 f = 0; f < 6; ++f)
+				{
+					const int32* Q = FaceCorners[f];
+					for (int32 i = 0; i < 4; ++i)
+					{
+						const int32 Prev = Q[(i + 3) % 4];
+						if (IsInside(Q[i]) == false || IsInside(Prev))
+						{
+							continue;
+						}
+						int32 Last = i;
+						while (IsInside(Q[(Last + 1) % 4]))
+						{
+							Last = (Last + 1) % 4;
+						}
+						const int32 EntryEdge = EdgeOfCorners[Prev][Q[i]];
+						const int32 ExitEdge = EdgeOfCorners[Q[Last]][Q[(Last + 1) % 4]];
+						// loops run clockwise seen from outside, so the triangles face outward with the left-handed VectorUtil::Normal
+						NextEdge[ExitEdge] = EntryEdge;
+					}
+				}
+
+				bool bVisited[12] = {};
+				for (int32 e = 0; e < 12; ++e)
+				{
+					if (NextEdge[e] < 0 || bVisited[e])
+					{
+						continue;
+					}
+					TArray<int32, TInlineAllocator<12>> Loop;
+					for (int32 Edge = e; bVisited[Edge] == false; Edge = NextEdge[Edge])
+					{
+						bVisited[Edge] = true;
+						Loop.Add(Edge);
+					}
+					for (int32 k = 1; k + 1 < Loop.Num(); ++k)
+					{
+						CaseTriangles[Case].Add(FIndex3i(Loop[0], Loop[k], Loop[k + 1]));
+					}
+				}
+			}
+		}
+	};
+
+	static const FCubeTables& GetCubeTables()
+	{
+		static const FCubeTables Tables;
+		return Tables;
+	}
+}
+
+
+struct FTiledMarchingCubesGenerator::FTileResult
+{
+	bool bChanged = false;
+	TArray<float> Samples;
+	TArray<FEdgeKey> VertexKeys;
+	TArray<FVector3d> VertexPositions;
+	TArray<FIndex3i> Triangles;
+};
+
+
+void FTiledMarchingCubesGenerator::GetTileRange(const FVector3d& Center, double Radius, FIntVector& MinTile, FIntVector& MaxTile) const
+{
+	const double TileSize = CubeSize * TileCells;
+	MinTile = FIntVector(
+		FMath::FloorToInt32((Center.X - Radius) / TileSize), FMath::FloorToInt32((Center.Y - Radius) / TileSize), FMath::FloorToInt32((Center.Z - Radius) / TileSize));
+	MaxTile = FIntVector(
+		FMath::FloorToInt32((Center.X + Radius) / TileSize), FMath::FloorToInt32((Center.Y + Radius) / TileSize), FMath::FloorToInt32((Center.Z + Radius) / TileSize));
+}
+
+
+void FTiledMarchingCubesGenerator::AddProbeToTiles(const FVector3d& Position, int32 Delta)
+{
+	// one extra cell so lattice points on the shared face of two tiles are covered by both
+	FIntVector MinTile, MaxTile;
+	GetTileRange(Position, TilesSurfaceDistance + CubeSize, MinTile, MaxTile);
+	for (int32 z = MinTile.Z; z <= MaxTile.Z; ++z)
+	{
+		for (int32 y = MinTile.Y; y <= MaxTile.Y; ++y)
+		{
+			for (int32 x = MinTile.X; x <= MaxTile.X; ++x)
+			{
+				Tiles.FindOrAdd(FIntVector(x, y, z)).NumProbes += Delta;
+			}
+		}
+	}
+}
+
+
+void FTiledMarchingCubesGenerator::MarkTilesDirty(const FVector3d& Position)
+{
+	FIntVector MinTile, MaxTile;
+	GetTileRange(Position, TilesInfluenceRadius + CubeSize, MinTile, MaxTile);
+	for (int32 z = MinTile.Z; z <= MaxTile.Z; ++z)
+	{
+		for (int32 y = MinTile.Y; y <= MaxTile.Y; ++y)
+		{
+			for (int32 x = MinTile.X; x <= MaxTile.X; ++x)
+			{
+				if (FTile* Tile = Tiles.Find(FIntVector(x, y, z)))
+				{
+					Tile->bDirty = true;
+				}
+			}
+		}
+	}
+}
+
+
+void FTiledMarchingCubesGenerator::SetProbes(TArrayView<const FVector3d> Positions, TArrayView<const double> Values, double InfluenceRadius, double SurfaceDistance)
+{
+	if (CubeSize != TilesCubeSize || TileCells != TilesTileCells || InfluenceRadius != TilesInfluenceRadius || SurfaceDistance != TilesSurfaceDistance)
+	{
+		Tiles.Reset();
+		ProbePositions.Reset();
+		ProbeValues.Reset();
+		TilesCubeSize = CubeSize;
+		TilesTileCells = TileCells;
+		TilesInfluenceRadius = InfluenceRadius;
+		TilesSurfaceDistance = SurfaceDistance;
+		bNeedsFullRebuild = true;
+	}
+
+	const int32 NumOld = ProbePositions.Num();
+	const int32 NumNew = Positions.Num();
+	for (int32 i = 0; i < FMath::Max(NumOld, NumNew); ++i)
+	{
+		const double NewValue = Values.IsValidIndex(i) ? Values[i] : 1.0;
+		if (i < NumOld && i < NumNew && Positions[i] == ProbePositions[i] && NewValue == ProbeValues[i])
+		{
+			continue;
+		}
+		if (i < NumOld)
+		{
+			MarkTilesDirty(ProbePositions[i]);
+			AddProbeToTiles(ProbePositions[i], -1);
+		}
+		if (i < NumNew)
+		{
+			AddProbeToTiles(Positions[i], 1);
+			MarkTilesDirty(Positions[i]);
+		}
+	}
+
+	ProbePositions = TArray<FVector3d>(Positions.GetData(), NumNew);
+	ProbeValues.SetNum(NumNew);
+	for (int32 i = 0; i < NumNew; ++i)
+	{
+		ProbeValues[i] = Values.IsValidIndex(i) ? Values[i] : 1.0;
+	}
+}
+
+
+void FTiledMarchingCubesGenerator::ReleaseTile(FDynamicMesh3& Mesh, FTile& Tile)
+{
+	for (int32 tid : Tile.MeshTriangles)
+	{
+		if (Mesh.IsTriangle(tid))
+		{
+			Mesh.RemoveTriangle(tid, false);
+		}
+	}
+	Tile.MeshTriangles.Reset();
+
+	for (const FEdgeKey& Key : Tile.EdgeKeys)
+	{
+		FEdgeVertex* EdgeVertex = EdgeVertices.Find(Key);
+		if (EdgeVertex != nullptr && --EdgeVertex->NumTiles <= 0)
+		{
+			if (Mesh.IsVertex(EdgeVertex->VertexID))
+			{
+				Mesh.RemoveVertex(EdgeVertex->VertexID);
+			}
+			EdgeVertices.Remove(Key);
+		}
+	}
+	Tile.EdgeKeys.Reset();
+	Tile.bPolygonized = false;
+}
+
+
+int32 FTiledMarchingCubesGenerator::UpdateMesh(FDynamicMesh3& Mesh, bool bFullRebuild)
+{
+	using namespace TiledMarchingCubesGeneratorLocal;
+
+	if (bFullRebuild || bNeedsFullRebuild)
+	{
+		Mesh = FDynamicMesh3();
+		EdgeVertices.Reset();
+		for (TPair<FIntVector, FTile>& Pair : Tiles)
+		{
+			Pair.Value.MeshTriangles.Reset();
+			Pair.Value.EdgeKeys.Reset();
+			Pair.Value.Samples.Reset();
+			Pair.Value.bPolygonized = false;
+			Pair.Value.bDirty = true;
+		}
+		bNeedsFullRebuild = false;
+	}
+
+	// tiles that are no longer near any probe
+	for (auto It = Tiles.CreateIterator(); It; ++It)
+	{
+		if (It->Value.NumProbes <= 0)
+		{
+			ReleaseTile(Mesh, It->Value);
+			It.RemoveCurrent();
+		}
+	}
+
+	TArray<FIntVector> DirtyKeys;
+	TArray<FTile*> DirtyTiles;
+	for (TPair<FIntVector, FTile>& Pair : Tiles)
+	{
+		if (Pair.Value.bDirty)
+		{
+			DirtyKeys.Add(Pair.Key);
+			DirtyTiles.Add(&Pair.Value);
+		}
+	}
+	if (DirtyTiles.Num() == 0 || !Implicit)
+	{
+		return 0;
+	}
+
+	const FCubeTables& Tables = GetCubeTables();
+	const int32 N = TileCells;
+	const int32 NP = N + 1;
+	auto SampleIndex = [NP](int32 x, int32 y, int32 z) { return (z * NP + y) * NP + x; };
+
+	TArray<FTileResult> Results;
+	Results.SetNum(DirtyTiles.Num());
+	ParallelFor(DirtyTiles.Num(), [&](int32 k)
+	{
+		const FTile& Tile = *DirtyTiles[k];
+		FTileResult& Result = Results[k];
+		const FIntVector Base = DirtyKeys[k] * N;
+
+		Result.Samples.SetNumUninitialized(NP * NP * NP);
+		for (int32 z = 0; z < NP; ++z)
+		{
+			for (int32 y = 0; y < NP; ++y)
+			{
+				for (int32 x = 0; x < NP; ++x)
+				{
+					Result.Samples[SampleIndex(x, y, z)] = (float)Implicit(FVector3d(Base.X + x, Base.Y + y, Base.Z + z) * CubeSize);
+				}
+			}
+		}
+
+		// a tile inside the influence radius whose samples didn't change, eg outside the support of a metaball, keeps its triangles
+		if (Tile.bPolygonized && Result.Samples == Tile.Samples)
+		{
+			return;
+		}
+		Result.bChanged = true;
+
+		// crossing of the lattice edge from P0 to P1, refined by bisection. Only depends on the edge, so both tiles sharing it agree
+		auto FindCrossing = [this](const FVector3d& P0, double F0, const FVector3d& P1, double F1)
+		{
+			double A = 0, B = 1;
+			const bool bInside0 = (F0 >= IsoValue);
+			for (int32 Step = 0; Step < RootModeSteps; ++Step)
+			{
+				const double Mid = 0.5 * (A + B);
+				const double FMid = Implicit(P0 + Mid * (P1 - P0));
+				if ((FMid >= IsoValue) == bInside0)
+				{
+					A = Mid;
+					F0 = FMid;
+				}
+				else
+				{
+					B = Mid;
+					F1 = FMid;
+				}
+			}
+			const double t = (F1 != F0) ? FMath::Clamp((IsoValue - F0) / (F1 - F0), 0.0, 1.0) : 0.5;
+			return P0 + (A + t * (B - A)) * (P1 - P0);
+		};
+
+		TArray<int32> LocalEdgeVertices;
+		LocalEdgeVertices.Init(-1, 3 * NP * NP * NP);
+		for (int32 z = 0; z < N; ++z)
+		{
+			for (int32 y = 0; y < N; ++y)
+			{
+				for (int32 x = 0; x < N; ++x)
+				{
+					float F[8];
+					int32 Case = 0;
+					for (int32 c = 0; c < 8; ++c)
+					{
+						F[c] = Result.Samples[SampleIndex(x + (c & 1), y + ((c >> 1) & 1), z + ((c >> 2) & 1))];
+						Case |= (F[c] >= IsoValue) ? (1 << c) : 0;
+					}
+					for (const FIndex3i& CaseTri : Tables.CaseTriangles[Case])
+					{
+						FIndex3i Tri;
+						for (int32 j = 0; j < 3; ++j)
+						{
+							const int32 Edge = CaseTri[j];
+							const int32 C0 = Tables.EdgeCorners[Edge][0], C1 = Tables.EdgeCorners[Edge][1];
+							const FIntVector Local(x + (C0 & 1), y + ((C0 >> 1) & 1), z + ((C0 >> 2) & 1));
+							int32& Vertex = LocalEdgeVertices[3 * SampleIndex(Local.X, Local.Y, Local.Z) + Tables.EdgeAxis[Edge]];
+							if (Vertex < 0)
+							{
+								const FIntVector P0 = Base + Local;
+								FIntVector P1 = P0;
+								P1[Tables.EdgeAxis[Edge]] += 1;
+								Vertex = Result.VertexPositions.Add(FindCrossing(FVector3d(P0) * CubeSize, F[C0], FVector3d(P1) * CubeSize, F[C1]));
+								Result.VertexKeys.Add(FEdgeKey{ P0, Tables.EdgeAxis[Edge] });
+							}
+							Tri[j] = Vertex;
+						}
+						Result.Triangles.Add(Tri);
+					}
+				}
+			}
+		}
+	}, !bParallelCompute);
+
+	// remove the old triangles of all changed tiles first, so vertices shared by changed tiles are rebuilt
+	int32 NumChanged = 0;
+	for (int32 k = 0; k < DirtyTiles.Num(); ++k)
+	{
+		if (Results[k].bChanged)
+		{
+			ReleaseTile(Mesh, *DirtyTiles[k]);
+			NumChanged++;
+		}
+	}
+
+	TArray<int32> MeshVertices;
+	int32 NumFailedTriangles = 0;		// non-manifold triangles, eg from ambiguous cube configurations
+	for (int32 k = 0; k < DirtyTiles.Num(); ++k)
+	{
+		FTile& Tile = *DirtyTiles[k];
+		FTileResult& Result = Results[k];
+		Tile.bDirty = false;
+		if (Result.bChanged == false)
+		{
+			continue;
+		}
+
+		MeshVertices.SetNum(Result.VertexKeys.Num());
+		for (int32 i = 0; i < Result.VertexKeys.Num(); ++i)
+		{
+			FEdgeVertex& EdgeVertex = EdgeVertices.FindOrAdd(Result.VertexKeys[i]);
+			if (EdgeVertex.NumTiles == 0)
+			{
+				EdgeVertex.VertexID = Mesh.AppendVertex(Result.VertexPositions[i]);
+			}
+			EdgeVertex.NumTiles++;
+			MeshVertices[i] = EdgeVertex.VertexID;
+		}
+		Tile.EdgeKeys = MoveTemp(Result.VertexKeys);
+
+		Tile.MeshTriangles.Reserve(Result.Triangles.Num());
+		for (const FIndex3i& Tri : Result.Triangles)
+		{
+			const int32 tid = Mesh.AppendTriangle(MeshVertices[Tri.A], MeshVertices[Tri.B], MeshVertices[Tri.C]);
+			if (tid >= 0)
+			{
+				Tile.MeshTriangles.Add(tid);
+			}
+			else
+			{
+				NumFailedTriangles++;
+			}
+		}
+		Tile.Samples = MoveTemp(Result.Samples);
+		Tile.bPolygonized = true;
+	}
+
+	if (NumFailedTriangles > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TiledMarchingCubes: %d triangles could not be added to the mesh"), NumFailedTriangles);
+	}
+
+	return NumChanged;
+}
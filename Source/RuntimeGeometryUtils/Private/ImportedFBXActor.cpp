@@ -3,6 +3,7 @@
 
 #include "ImportedFBXActor.h"
 #include "Components/DynamicMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "MeshComponentRuntimeUtils.h"
 
 
@@ -12,29 +13,52 @@ AImportedFBXActor::AImportedFBXActor()
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	// mesh components are placed relative to the root, at their node transforms
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 }
 
-void AImportedFBXActor::AddMeshComponent(FName MeshName, UE::Geometry::FDynamicMesh3& SourceMesh)
+UStaticMesh* AImportedFBXActor::CreateStaticMesh(UE::Geometry::FDynamicMesh3& SourceMesh)
 {
-	UStaticMeshComponent* NewComponent = NewObject<UStaticMeshComponent>(this, MeshName);
+	UStaticMesh* MyStaticMesh = NewObject<UStaticMesh>(this);
+	RTGUtils::UpdateStaticMeshFromDynamicMesh(MyStaticMesh, &SourceMesh);
+	return MyStaticMesh;
+}
+
+void AImportedFBXActor::AddMeshComponent(FName MeshName, UE::Geometry::FDynamicMesh3& SourceMesh, const FTransform& Transform)
+{
+	// node names are not unique in FBX files
+	UStaticMeshComponent* NewComponent = NewObject<UStaticMeshComponent>(this, MakeUniqueObjectName(this, UStaticMeshComponent::StaticClass(), MeshName));
 
 	if (NewComponent)
 	{
-		UStaticMesh* MyStaticMesh = NewObject<UStaticMesh>();
-		NewComponent->SetStaticMesh(MyStaticMesh);
-
-		RTGUtils::UpdateStaticMeshFromDynamicMesh(MyStaticMesh, &SourceMesh);
+		NewComponent->SetStaticMesh(CreateStaticMesh(SourceMesh));
+		NewComponent->SetRelativeTransform(Transform);
 
 		NewComponent->RegisterComponent();
 		NewComponent->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
 
-		
 		// Add to Mesh Array
 		MeshComponents.Add(NewComponent);
 	}
 
 }
 
+void AImportedFBXActor::AddInstancedMeshComponent(FName MeshName, UE::Geometry::FDynamicMesh3& SourceMesh, const TArray<FTransform>& InstanceTransforms)
+{
+	UInstancedStaticMeshComponent* NewComponent = NewObject<UInstancedStaticMeshComponent>(this, MakeUniqueObjectName(this, UInstancedStaticMeshComponent::StaticClass(), MeshName));
+
+	if (NewComponent)
+	{
+		NewComponent->SetStaticMesh(CreateStaticMesh(SourceMesh));
+
+		NewComponent->RegisterComponent();
+		NewComponent->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+		NewComponent->AddInstances(InstanceTransforms, false);
+
+		InstancedMeshComponents.Add(NewComponent);
+	}
+}
+
 int32 AImportedFBXActor::CountComponents()
 {
 	return GetComponents().Num();
@@ -0,0 +1,109 @@
+#include "MeshImportCacheSubsystem.h"
+#include "Engine/Engine.h"
+#include "DynamicMeshAttributeUtils.h"
+
+using namespace UE::Geometry;
+
+
+UMeshImportCacheSubsystem* UMeshImportCacheSubsystem::Get()
+{
+	return (GEngine) ? GEngine->GetEngineSubsystem<UMeshImportCacheSubsystem>() : nullptr;
+}
+
+
+void UMeshImportCacheSubsystem::Deinitialize()
+{
+	ClearImportCache();
+	Super::Deinitialize();
+}
+
+
+TSharedPtr<const FDynamicMesh3> UMeshImportCacheSubsystem::Find(const FString& Key)
+{
+	FScopeLock Lock(&CacheLock);
+	int32 Index = CachedImports.IndexOfByPredicate([&Key](const FCachedImport& Cached) { return Cached.Key == Key; });
+	if (Index == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	// move to the back of the LRU list
+	FCachedImport Found = MoveTemp(CachedImports[Index]);
+	CachedImports.RemoveAt(Index);
+	TSharedPtr<const FDynamicMesh3> Mesh = Found.Mesh;
+	CachedImports.Add(MoveTemp(Found));
+	return Mesh;
+}
+
+
+TSharedPtr<const FDynamicMesh3> UMeshImportCacheSubsystem::FindOrBuild(const FString& Key, TFunctionRef<bool(FDynamicMesh3&)> BuildMesh)
+{
+	if (TSharedPtr<const FDynamicMesh3> Found = Find(Key))
+	{
+		return Found;
+	}
+
+	TSharedPtr<FDynamicMesh3> NewMesh = MakeShared<FDynamicMesh3>();
+	if (BuildMesh(*NewMesh) == false)
+	{
+		return nullptr;
+	}
+
+	FScopeLock Lock(&CacheLock);
+	// another thread may have built the same mesh in the meantime
+	for (const FCachedImport& Cached : CachedImports)
+	{
+		if (Cached.Key == Key)
+		{
+			return Cached.Mesh;
+		}
+	}
+
+	FCachedImport& NewCached = CachedImports.AddDefaulted_GetRef();
+	NewCached.Key = Key;
+	NewCached.Bytes = RTGUtils::EstimateMeshByteCount(*NewMesh);
+	NewCached.Mesh = NewMesh;
+	CachedBytes += NewCached.Bytes;
+	EvictToBudget();
+
+	return NewMesh;
+}
+
+
+void UMeshImportCacheSubsystem::EvictToBudget()
+{
+	const int64 BudgetBytes = FMath::Max((int64)MemoryBudgetMB, (int64)0) * 1024 * 1024;
+	int32 NumEvicted = 0;
+	while (CachedBytes > BudgetBytes && CachedImports.Num() - NumEvicted > 1)
+	{
+		CachedBytes -= CachedImports[NumEvicted].Bytes;
+		NumEvicted++;
+	}
+	if (NumEvicted > 0)
+	{
+		CachedImports.RemoveAt(0, NumEvicted);
+		UE_LOG(LogTemp, Display, TEXT("MeshImportCache: evicted %d meshes, %lld bytes cached"), NumEvicted, CachedBytes);
+	}
+}
+
+
+void UMeshImportCacheSubsystem::ClearImportCache()
+{
+	FScopeLock Lock(&CacheLock);
+	CachedImports.Empty();
+	CachedBytes = 0;
+}
+
+
+int64 UMeshImportCacheSubsystem::GetCachedBytes() const
+{
+	FScopeLock Lock(&CacheLock);
+	return CachedBytes;
+}
+
+
+int32 UMeshImportCacheSubsystem::GetNumCachedMeshes() const
+{
+	FScopeLock Lock(&CacheLock);
+	return CachedImports.Num();
+}
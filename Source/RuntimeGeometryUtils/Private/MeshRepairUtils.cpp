@@ -0,0 +1,81 @@
+#include "MeshRepairUtils.h"
+
+#include "MeshBoundaryLoops.h"
+#include "DynamicMeshEditor.h"
+#include "Operations/MinimalHoleFiller.h"
+#include "Operations/SimpleHoleFiller.h"
+
+using namespace UE::Geometry;
+
+void RTGUtils::FillMeshHoles(
+	FDynamicMesh3& Mesh,
+	int32& NumFilledHoles,
+	int32& NumFailedHoleFills,
+	const TArray<int>* OnlyLoopsWithEdges)
+{
+	NumFilledHoles = 0;
+	NumFailedHoleFills = 0;
+
+	if (OnlyLoopsWithEdges != nullptr && OnlyLoopsWithEdges->Num() == 0)
+	{
+		return;
+	}
+
+	FMeshBoundaryLoops Loops(&Mesh, true);
+
+	TSet<int> FilterEdges;
+	if (OnlyLoopsWithEdges != nullptr)
+	{
+		FilterEdges.Append(*OnlyLoopsWithEdges);
+	}
+
+	for (const FEdgeLoop& Loop : Loops.Loops)
+	{
+		if (OnlyLoopsWithEdges != nullptr)
+		{
+			bool bSelected = false;
+			for (int EdgeID : Loop.Edges)
+			{
+				if (FilterEdges.Contains(EdgeID))
+				{
+					bSelected = true;
+					break;
+				}
+			}
+			if (!bSelected)
+			{
+				continue;
+			}
+		}
+
+		int NewGroupID = (Mesh.HasTriangleGroups()) ? Mesh.AllocateTriangleGroup() : -1;
+
+		bool bFilled = false;
+		TArray<int32> NewTriangles;
+		if (Loop.GetVertexCount() <= 3)
+		{
+			FSimpleHoleFiller Filler(&Mesh, Loop, FSimpleHoleFiller::EFillType::TriangleFan);
+			bFilled = Filler.Fill(NewGroupID);
+			NewTriangles = MoveTemp(Filler.NewTriangles);
+		}
+		else
+		{
+			FMinimalHoleFiller Filler(&Mesh, Loop);
+			bFilled = Filler.Fill(NewGroupID);
+			NewTriangles = MoveTemp(Filler.NewTriangles);
+		}
+
+		if (!bFilled)
+		{
+			NumFailedHoleFills++;
+			continue;
+		}
+
+		NumFilledHoles++;
+		if (Mesh.HasAttributes() && NewTriangles.Num() > 0)
+		{
+			FDynamicMeshEditor Editor(&Mesh);
+			Editor.SetTriangleNormals(NewTriangles);
+		}
+	}
+}
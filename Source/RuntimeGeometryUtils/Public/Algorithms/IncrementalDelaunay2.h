@@ -0,0 +1,132 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IndexTypes.h"
+
+/**
+ * 2D constrained Delaunay triangulation that is kept alive and edited incrementally.
+ *
+ * Vertices are inserted by walking to the containing triangle, splitting it (or the edge the point lies on) and restoring
+ * the Delaunay property with Lawson flips. Vertices are removed by re-triangulating their star. Constraint edges are
+ * forced in by flipping the edges they cross, collinear vertices split a constraint into sub-segments. All predicates
+ * are exact (see PointTriangleRelation).
+ *
+ * The triangulation lives inside a fixed super triangle, so coordinates must be within +/- MaxCoordinate. The
+ * triangles that were created, modified or deleted since the last call to UpdateOutputTriangles() are tracked, so
+ * callers can update their own copy of the output instead of rebuilding it.
+ */
+class RUNTIMEGEOMETRYUTILS_API FIncrementalDelaunay2
+{
+public:
+	FIncrementalDelaunay2();
+
+	/** Number of vertex IDs used by the super triangle, the first real vertex ID is NumSuperVertices */
+	static constexpr int32 NumSuperVertices = 3;
+
+	/** Inserted points must be within this range on both axes */
+	static constexpr float MaxCoordinate = 1.0e12f;
+
+	/**
+	 * If true and there are constraint edges, only triangles enclosed by an odd number of constraint loops are output,
+	 * so an outer loop and hole loops give the filled region. Otherwise all triangles of the convex hull are output.
+	 */
+	bool bFillByParity = true;
+
+	/** Remove all vertices, triangles and constraints */
+	void Reset();
+
+	/**
+	 * Insert a vertex. Inserting a position that is already a vertex returns that vertex and adds a reference to it.
+	 * @return the vertex ID, or -1 if the position is out of range
+	 */
+	int32 InsertVertex(const FVector2f& Position);
+
+	/**
+	 * Remove a reference to a vertex and remove the vertex if it was the last one. Vertices that are the endpoint of a
+	 * constraint can't be removed; a vertex that splits a single straight constraint is removed and the constraint kept.
+	 */
+	bool RemoveVertex(int32 VertexID);
+
+	/**
+	 * Add a constraint edge between two vertices. Constraints that cross an existing constraint are rejected.
+	 * Adding the same constraint twice adds a reference to it.
+	 */
+	bool InsertConstraint(int32 VertexA, int32 VertexB);
+
+	/** Remove a reference to a constraint edge; the edges are made Delaunay again when the last reference is removed */
+	bool RemoveConstraint(int32 VertexA, int32 VertexB);
+
+	bool IsVertex(int32 VertexID) const { return VertexID >= NumSuperVertices && VertexID < VertexRefCounts.Num() && VertexRefCounts[VertexID] > 0; }
+	const FVector2f& GetVertex(int32 VertexID) const { return Vertices[VertexID]; }
+	int32 MaxVertexID() const { return Vertices.Num(); }
+
+	bool IsTriangle(int32 TriangleID) const { return TriangleID >= 0 && TriangleID < TriangleAlive.Num() && TriangleAlive[TriangleID]; }
+	const UE::Geometry::FIndex3i& GetTriangle(int32 TriangleID) const { return Triangles[TriangleID]; }
+	int32 MaxTriangleID() const { return Triangles.Num(); }
+
+	bool IsConstrainedEdge(int32 VertexA, int32 VertexB) const { return ConstrainedEdges.Contains(EdgeKey(VertexA, VertexB)); }
+	int32 NumConstrainedEdges() const { return ConstrainedEdges.Num(); }
+
+	/**
+	 * Update the output flags of all triangles and return the triangles whose geometry or output flag changed since the
+	 * last call. Triangles in the list may have been deleted.
+	 */
+	void UpdateOutputTriangles(TArray<int32>& ChangedTrianglesOut);
+
+	/** true if the triangle is part of the output, as of the last UpdateOutputTriangles() */
+	bool IsOutputTriangle(int32 TriangleID) const { return TriangleID < TriangleOutput.Num() && TriangleOutput[TriangleID]; }
+
+protected:
+	TArray<FVector2f> Vertices;
+	TArray<int32> VertexRefCounts;			// 0 for unused vertex IDs
+	TArray<int32> VertexTriangles;			// one triangle incident to each vertex
+	TArray<int32> FreeVertices;
+
+	// triangles are counter-clockwise. Neighbor e is the triangle across edge (Tri[e], Tri[(e+1)%3]), -1 outside the super triangle
+	TArray<UE::Geometry::FIndex3i> Triangles;
+	TArray<UE::Geometry::FIndex3i> TriangleNeighbors;
+	TArray<bool> TriangleAlive;
+	TArray<int32> FreeTriangles;
+
+	// number of constraints through each constrained edge
+	TMap<uint64, int32> ConstrainedEdges;
+
+	TSet<int32> ChangedTriangles;
+	TArray<bool> TriangleOutput;
+	int32 LastTriangle = 0;
+
+	static uint64 EdgeKey(int32 A, int32 B) { return ((uint64)FMath::Min(A, B) << 32) | (uint64)FMath::Max(A, B); }
+
+	int32 AllocateVertex(const FVector2f& Position);
+	int32 AllocateTriangle();
+	void FreeTriangle(int32 TriangleID);
+	void SetTriangle(int32 TriangleID, const UE::Geometry::FIndex3i& Tri, const UE::Geometry::FIndex3i& Neighbors);
+
+	/** Set neighbor Edge of TriangleID to Neighbor, and the matching neighbor of Neighbor to TriangleID */
+	void LinkNeighbor(int32 TriangleID, int32 Edge, int32 Neighbor);
+
+	/** Triangles around a vertex, counter-clockwise */
+	void GetVertexTriangles(int32 VertexID, TArray<int32>& TrianglesOut) const;
+
+	/** @return the triangle that has the directed edge (A,B) as edge EdgeOut, or -1 */
+	int32 FindEdge(int32 A, int32 B, int32& EdgeOut) const;
+
+	/** @return the triangle containing Position, on its boundary included, or -1 */
+	int32 LocateTriangle(const FVector2f& Position) const;
+
+	void SplitTriangle(int32 TriangleID, int32 VertexID, TArray<TPair<int32, int32>>& EdgeStack);
+	void SplitEdge(int32 TriangleID, int32 Edge, int32 VertexID, TArray<TPair<int32, int32>>& EdgeStack);
+
+	/** Flip edge e of T = (A,B,P) with M = (B,A,D) across it, to T = (P,A,D) and M = (D,B,P) */
+	void FlipEdge(int32 T, int32 Edge);
+
+	/** Flip the (triangle, edge) pairs in EdgeStack, and the edges they expose, until they are locally Delaunay. Constrained edges are not flipped */
+	void LegalizeEdges(TArray<TPair<int32, int32>>& EdgeStack);
+
+	bool InsertConstraintSegment(int32 A, int32 B, int32 Depth);
+
+	/** Find the constrained edges that make up the straight constraint from A to B */
+	bool FindConstraintChain(int32 A, int32 B, TArray<UE::Geometry::FIndex2i>& EdgesOut) const;
+};
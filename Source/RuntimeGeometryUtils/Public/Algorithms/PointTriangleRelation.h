@@ -3,12 +3,42 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "IndexTypes.h"
+
+/** Location of a point relative to a triangle */
+enum class EPointTriangleLocation : uint8
+{
+	Outside,
+	Inside,
+	OnEdge,
+	OnVertex
+};
 
 /**
- * 
+ * 2D point/triangle predicates. Orientations are computed in double with a floating-point error filter and fall back
+ * to the exact (adaptive) predicates of GeometryCore when the sign is uncertain, so points on edges or vertices are
+ * classified consistently instead of depending on rounding.
  */
 class RUNTIMEGEOMETRYUTILS_API PointTriangleRelation
 {
 public:
- static bool IsPointInTriangle2D(FVector2f& TestPoint, FVector2f& PointA,  FVector2f& PointB, FVector2f& PointC);
+ static bool IsPointInTriangle2D(const FVector2f& TestPoint, const FVector2f& PointA, const FVector2f& PointB, const FVector2f& PointC);
+
+	/** Sign of the signed area of ABC: > 0 if counter-clockwise, < 0 if clockwise, 0 if exactly collinear */
+	static double Orient2D(const FVector2f& A, const FVector2f& B, const FVector2f& C);
+
+	/** > 0 if P is inside the circumcircle of the counter-clockwise triangle ABC, 0 if exactly on it */
+	static double InCircle2D(const FVector2f& A, const FVector2f& B, const FVector2f& C, const FVector2f& P);
+
+	/**
+	 * Classify TestPoint against triangle ABC, which may have either orientation. Degenerate triangles contain nothing.
+	 * @param EdgeOrVertexOut for OnEdge, the edge index e of edge (V[e], V[(e+1)%3]); for OnVertex, the vertex index
+	 */
+	static EPointTriangleLocation ClassifyPointInTriangle2D(const FVector2f& TestPoint, const FVector2f& PointA, const FVector2f& PointB, const FVector2f& PointC, int32& EdgeOrVertexOut);
+
+	/**
+	 * Find the first of Triangles (indices into Vertices) that contains TestPoint, on an edge or vertex included.
+	 * @return the triangle index, or -1 if no triangle contains the point
+	 */
+	static int32 FindTriangleContainingPoint2D(const FVector2f& TestPoint, TArrayView<const FVector2f> Vertices, TArrayView<const UE::Geometry::FIndex3i> Triangles, EPointTriangleLocation& LocationOut, int32& EdgeOrVertexOut);
 };
@@ -0,0 +1,100 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BoxTypes.h"
+
+/**
+ * Snapshot of probe positions and values, indexed by a uniform grid for radius-limited queries.
+ * The grid is stored in compressed form: the probes are sorted by cell, and CellStarts[c] .. CellStarts[c+1] is the
+ * range of probes in cell c. After Build() the field is read-only and can be queried from parallel workers.
+ */
+class RUNTIMEGEOMETRYUTILS_API FProbeField
+{
+public:
+	/**
+	 * Build the grid. Queries only consider probes within CutoffRadius of the query point.
+	 * @param Values per-probe values, may be empty
+	 */
+	void Build(TArrayView<const FVector3d> Positions, TArrayView<const double> Values, double CutoffRadius);
+
+	int32 Num() const { return Positions.Num(); }
+	double GetCutoffRadius() const { return CutoffRadius; }
+	const UE::Geometry::FAxisAlignedBox3d& GetBounds() const { return Bounds; }
+	double GetMaxValue() const { return MaxValue; }
+
+	/**
+	 * Find the probe nearest to Point within the cutoff radius.
+	 * @return false if there is no probe within the cutoff radius
+	 */
+	bool FindNearest(const FVector3d& Point, int32& ProbeIndexOut, double& DistanceOut) const;
+
+	/**
+	 * Metaball field: sum of Value * (1 - d^2/R^2)^3 over the probes, with R the cutoff radius. The falloff and its
+	 * first two derivatives are continuous and reach 0 at R, so blobs blend smoothly and the field has bounded support.
+	 */
+	double EvaluateMetaball(const FVector3d& Point) const;
+
+	/**
+	 * Negated signed distance to the union of spheres of radius Value * SphereRadius around the probes, blended with a
+	 * polynomial smooth minimum of width Blend. The cutoff radius must be at least SphereRadius * GetMaxValue() + 2 * Blend,
+	 * further probes can't change the sign of the result.
+	 */
+	double EvaluateSmoothMin(const FVector3d& Point, double SphereRadius, double Blend) const;
+
+	/** Call Func(ProbeIndex, Position, Value, DistanceSquared) for every probe within the cutoff radius of Point */
+	template<typename FuncType>
+	void ForEachWithinCutoff(const FVector3d& Point, FuncType&& Func) const
+	{
+		if (Positions.Num() == 0)
+		{
+			return;
+		}
+		const double CutoffSqr = CutoffRadius * CutoffRadius;
+		FIntVector MinCell = GetCell(Point - FVector3d(CutoffRadius));
+		FIntVector MaxCell = GetCell(Point + FVector3d(CutoffRadius));
+		for (int32 z = MinCell.Z; z <= MaxCell.Z; ++z)
+		{
+			for (int32 y = MinCell.Y; y <= MaxCell.Y; ++y)
+			{
+				const int32 RowCell = (z * Dimensions.Y + y) * Dimensions.X;
+				const int32 First = CellStarts[RowCell + MinCell.X];
+				const int32 Last = CellStarts[RowCell + MaxCell.X + 1];
+				for (int32 k = First; k < Last; ++k)
+				{
+					const double DistSqr = FVector3d::DistSquared(Point, Positions[k]);
+					if (DistSqr <= CutoffSqr)
+					{
+						Func(ProbeIndices[k], Positions[k], Values[k], DistSqr);
+					}
+				}
+			}
+		}
+	}
+
+	/** Upper bound of the number of grid cells, the cell size is increased beyond the cutoff radius to stay within it */
+	static constexpr int64 MaxCells = 1 << 22;
+
+protected:
+	// sorted by cell
+	TArray<FVector3d> Positions;
+	TArray<double> Values;
+	TArray<int32> ProbeIndices;
+
+	TArray<int32> CellStarts;
+	FIntVector Dimensions = FIntVector::ZeroValue;
+	UE::Geometry::FAxisAlignedBox3d Bounds;
+	double CellSize = 1;
+	double CutoffRadius = 0;
+	double MaxValue = 0;
+
+	/** Cell containing Point, clamped to the grid */
+	FIntVector GetCell(const FVector3d& Point) const
+	{
+		return FIntVector(
+			FMath::Clamp((int32)((Point.X - Bounds.Min.X) / CellSize), 0, Dimensions.X - 1),
+			FMath::Clamp((int32)((Point.Y - Bounds.Min.Y) / CellSize), 0, Dimensions.Y - 1),
+			FMath::Clamp((int32)((Point.Z - Bounds.Min.Z) / CellSize), 0, Dimensions.Z - 1));
+	}
+};
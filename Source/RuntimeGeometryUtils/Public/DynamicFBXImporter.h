@@ -26,7 +26,46 @@ public:
 	UPROPERTY()
 	TArray<class UDynamicMeshComponent*> MeshComponents;
 
-	void BuildMesh(FbxNode* node, UE::Geometry::FDynamicMesh3& MeshOut);
+	/**
+	 * Convert an FBX mesh to a FDynamicMesh3, in the mesh's local space. Control points become vertices and polygons are fan-triangulated.
+	 * Normals, UVs and colors of the first layer are converted into the attribute overlays for any FBX mapping/reference mode,
+	 * so split normals and UV seams are kept. If the mesh has no normals and bNormals is set, per-vertex normals are computed.
+	 * This only reads from the FBX scene and can be called for different meshes in parallel.
+	 */
+	void BuildMesh(FbxMesh* fbx_mesh, UE::Geometry::FDynamicMesh3& MeshOut, bool bNormals, bool bTexCoords, bool bVertexColors, bool bReverseOrientation) const;
+
+	/** If true, mesh nodes that share geometry (the same FbxMesh, or identical control points, polygons, normals, UVs, colors and material indices) are created as instances of one UInstancedStaticMeshComponent */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions)
+	bool bInstanceRepeatedMeshes = true;
+
+	/** Minimum number of nodes sharing a geometry for it to be instanced */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions, meta = (ClampMin = 2))
+	int32 MinInstanceCount = 2;
+
+	/** If true, non-instanced mesh nodes with fewer than MergeTriangleThreshold triangles are merged into one static mesh component per material */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions)
+	bool bMergeSmallNodes = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions, meta = (EditCondition = "bMergeSmallNodes"))
+	int32 MergeTriangleThreshold = 2000;
+
+protected:
+
+	/** A geometry shared by one or more mesh nodes, and its converted mesh */
+	struct FImportedGeometry
+	{
+		FbxMesh* Mesh = nullptr;
+		TArray<int32> NodeIndices;
+		UE::Geometry::FDynamicMesh3 DynamicMesh;
+	};
+
+	/** Group MeshNodes by FbxMesh and, if bInstanceRepeatedMeshes is set, by identical geometry */
+	void GroupNodesByGeometry(const TArray<FbxNode*>& MeshNodes, TArray<FImportedGeometry>& GeometriesOut) const;
+
+	/** Transform of the node mesh relative to the scene root, including the node geometric offset */
+	static FTransform GetNodeMeshTransform(FbxNode* node);
+
+public:
 
 	FbxManager* SdkManager;
 	FbxIOSettings* ios;
@@ -34,10 +73,12 @@ public:
 
 public:
 
-	void IterateNode(FbxNode* node);
+	/** Add node and all its descendants that have a mesh attribute to MeshNodesOut */
+	void CollectMeshNodes(FbxNode* node, TArray<FbxNode*>& MeshNodesOut);
 
 	/**
-	 * Read mesh in FBX format from the given path into a FDynamicMesh3.
+	 * Read meshes in FBX format from the given path and spawn an AImportedFBXActor with one component per mesh node,
+	 * placed at the node transform. Repeated geometry is instanced and small nodes merged, see bInstanceRepeatedMeshes/bMergeSmallNodes.
 	 * @param bNormals should normals be imported into primary normal attribute overlay
 	 * @param bTexCoords should texture coordinates be imported into primary UV attribute overlay
 	 * @param bVertexColors should normals be imported into per-vertex colors
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "DynamicMesh/DynamicMeshTriangleAttribute.h"
+
+namespace RTGUtils
+{
+	/**
+	 * TScopedTriangleAttribute attaches a temporary per-triangle scalar attribute to a mesh for
+	 * the lifetime of the object, and removes it again on destruction (RAII). Use this for
+	 * bookkeeping attributes (eg sub-object IDs during a cut) that must not stay on the mesh
+	 * after the operation, otherwise they are carried through every Copy/SplitMesh/EditMesh.
+	 *
+	 * The attribute is looked up by name when detaching, so it is safe if the mesh attribute set
+	 * was replaced in the meantime (eg the mesh was overwritten via MoveTemp).
+	 */
+	template<typename AttribValueType>
+	class TScopedTriangleAttribute
+	{
+	public:
+		using FAttributeType = UE::Geometry::TDynamicMeshScalarTriangleAttribute<AttribValueType>;
+
+		TScopedTriangleAttribute(UE::Geometry::FDynamicMesh3& MeshIn, FName NameIn, AttribValueType InitialValue)
+			: Mesh(&MeshIn), Name(NameIn)
+		{
+			Mesh->EnableAttributes();
+			Attribute = new FAttributeType(Mesh);
+			Attribute->SetName(Name);
+			Attribute->Initialize(InitialValue);
+			Mesh->Attributes()->AttachAttribute(Name, Attribute);
+		}
+
+		~TScopedTriangleAttribute()
+		{
+			Detach();
+		}
+
+		TScopedTriangleAttribute(const TScopedTriangleAttribute&) = delete;
+		TScopedTriangleAttribute& operator=(const TScopedTriangleAttribute&) = delete;
+
+		/** Remove the attribute from the mesh now, instead of waiting for destruction */
+		void Detach()
+		{
+			if (Mesh && Mesh->HasAttributes() && Mesh->Attributes()->HasAttachedAttribute(Name))
+			{
+				Mesh->Attributes()->RemoveAttribute(Name);
+			}
+			Mesh = nullptr;
+			Attribute = nullptr;
+		}
+
+		FAttributeType* Get() const { return Attribute; }
+		FAttributeType* operator->() const { return Attribute; }
+		FName GetName() const { return Name; }
+
+	private:
+		UE::Geometry::FDynamicMesh3* Mesh = nullptr;
+		FAttributeType* Attribute = nullptr;
+		FName Name;
+	};
+
+
+	/**
+	 * Collect the memory used by each attribute attached to Mesh (via AttachAttribute) into AttributeBytes.
+	 * @return total bytes of all attached attributes
+	 */
+	RUNTIMEGEOMETRYUTILS_API int64 GetAttachedAttributeByteCounts(
+		const UE::Geometry::FDynamicMesh3& Mesh,
+		TMap<FName, int64>& AttributeBytes);
+
+	/**
+	 * Estimate the memory used by Mesh, including vertices/triangles/edges, overlays and attached attributes.
+	 * This is an estimate based on element counts, it does not include allocator slack.
+	 */
+	RUNTIMEGEOMETRYUTILS_API int64 EstimateMeshByteCount(const UE::Geometry::FDynamicMesh3& Mesh);
+}
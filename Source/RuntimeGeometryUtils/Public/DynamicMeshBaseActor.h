@@ -52,6 +52,21 @@ enum class EDynamicMeshActorPrimitiveType : uint8
 };
 
 
+/**
+ * Scalar field evaluated around the probes by the MarchingCubes primitive
+ */
+UENUM()
+enum class EDynamicMeshActorProbeFieldMode : uint8
+{
+	/** 100 / distance to the nearest probe with a fixed iso value of 0.5, probe values and IsoValue are ignored (the field of earlier versions) */
+	NearestDistance,
+	/** Sum of probe Value * (1 - d^2/R^2)^3 with R = ProbeInfluenceRadius */
+	Metaball,
+	/** Smooth union of spheres of radius probe Value * ProbeSphereRadius. IsoValue is the offset inward from the blended surface */
+	SmoothMin
+};
+
+
 /**
  * Boolean operation types supported of by ADynamicMeshBaseActor
  */
@@ -63,6 +78,31 @@ enum class EDynamicMeshActorBooleanOperation : uint8
 	Intersection
 };
 
+/**
+ * Outcome of the last Boolean operation computed by ADynamicMeshBaseActor
+ */
+USTRUCT(BlueprintType)
+struct FDynamicMeshBooleanResult
+{
+	GENERATED_BODY()
+
+	/** false if FMeshBoolean could not cleanly weld the cut and left open boundary edges */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Boolean)
+	bool bSucceeded = true;
+
+	/** Number of open boundary edges left by FMeshBoolean */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Boolean)
+	int32 NumOpenBoundaryEdges = 0;
+
+	/** Number of holes filled by the failure recovery */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Boolean)
+	int32 NumFilledHoles = 0;
+
+	/** Number of holes the failure recovery could not fill */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Boolean)
+	int32 NumFailedHoleFills = 0;
+};
+
 /*
 UENUM(BlueprintType)
 enum class EDynamicMeshActorCollisionMode : uint8
@@ -74,6 +114,12 @@ enum class EDynamicMeshActorCollisionMode : uint8
 */
 
 
+/** Progress of an asynchronous mesh export, Progress is the fraction of the file written */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnMeshExportProgress, float, Progress);
+
+/** Completion of an asynchronous mesh export, bSuccess is false if the file could not be written */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnMeshExportComplete, bool, bSuccess, const FString&, OutputPath);
+
 /**
  * ADynamicMeshBaseActor is a base class for Actors that support being
  * rebuilt in-game after mesh editing operations. The base Actor itself
@@ -154,6 +200,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite,Category = ImportOptions, meta = (EditCondition = "SourceType == EDynamicMeshActorSourceType::ImportedMesh", EditConditionHides))
 	float ImportScale = 1.0;
 
+	/** If true, per-vertex colors in the OBJ file ("v x y z r g b") are imported. Color storage is only allocated if the file has colors. Also applies to ImportMesh() */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions)
+	bool bImportVertexColors = true;
+
+	/** true if the last imported mesh has vertex colors, ie the file contained colors and bImportVertexColors was enabled */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = ImportOptions)
+	bool bImportedMeshHasVertexColors = false;
+
+	/** If true, the imported mesh is stored in a binary cache in Saved/RuntimeGeometryCache, and reloaded from there until the OBJ file changes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions, meta = (EditCondition = "SourceType == EDynamicMeshActorSourceType::ImportedMesh", EditConditionHides))
+	bool bUseImportCache = true;
+
+	/** If true, actors importing the same file with the same settings share one in-memory copy of the imported mesh (see UMeshImportCacheSubsystem) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = ImportOptions, meta = (EditCondition = "SourceType == EDynamicMeshActorSourceType::ImportedMesh", EditConditionHides))
+	bool bUseSharedImportCache = true;
+
 
 	//
 	// Parameters for SourceType = Primitive
@@ -190,6 +252,14 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite ,Category = PrimitiveOptions, meta = (EditCondition = "SourceType == EDynamicMeshActorSourceType::ConvexHull || SourceType == EDynamicMeshActorSourceType::ConcaveMesh"))
 	TArray<FVector2f> RandomPoints;
 
+	/** Constraint edges of the Delaunay primitive, as pairs of indices into RandomPoints. Closed loops bound the filled region, nested loops cut holes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = PrimitiveOptions, meta = (EditCondition = "SourceType == EDynamicMeshActorSourceType::Primitive && PrimitiveType == EDynamicMeshActorPrimitiveType::Delaunay", EditConditionHides))
+	TArray<FIntPoint> ConstraintEdges;
+
+	/** If > 0, the ConvexHull, RandomPoints and Delaunay primitives are extruded downward by this depth into a closed solid with top, bottom and side faces, instead of a flat sheet */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = PrimitiveOptions, meta = (UIMin = 0, EditCondition = "SourceType == EDynamicMeshActorSourceType::Primitive", EditConditionHides))
+	float ExtrusionDepth = 0;
+
 	//
 	// Parameters for SourceType = FromStaticMesh
 	//
@@ -201,11 +271,62 @@ public:
 	TArray<class AProbe*> SpatialPoints;
 
 	UPROPERTY(EditAnywhere, Category = MarchingCubes)
-	float Cubesize;
+	float Cubesize = 10;
+
+	/** Iso value of the Metaball and SmoothMin fields */
+	UPROPERTY(EditAnywhere, Category = MarchingCubes, meta = (EditCondition = "ProbeFieldMode != EDynamicMeshActorProbeFieldMode::NearestDistance"))
+	float IsoValue = 0.5;
+
+	UPROPERTY(EditAnywhere, Category = MarchingCubes)
+	EDynamicMeshActorProbeFieldMode ProbeFieldMode = EDynamicMeshActorProbeFieldMode::NearestDistance;
+
+	/** Radius beyond which a probe has no influence on the Metaball field */
+	UPROPERTY(EditAnywhere, Category = MarchingCubes, meta = (UIMin = 1, EditCondition = "ProbeFieldMode == EDynamicMeshActorProbeFieldMode::Metaball", EditConditionHides))
+	float ProbeInfluenceRadius = 400;
+
+	/** Radius of the sphere around a probe with Value 1 in the SmoothMin field */
+	UPROPERTY(EditAnywhere, Category = MarchingCubes, meta = (UIMin = 0, EditCondition = "ProbeFieldMode == EDynamicMeshActorProbeFieldMode::SmoothMin", EditConditionHides))
+	float ProbeSphereRadius = 150;
+
+	/** Width of the blend between spheres in the SmoothMin field */
+	UPROPERTY(EditAnywhere, Category = MarchingCubes, meta = (UIMin = 0, EditCondition = "ProbeFieldMode == EDynamicMeshActorProbeFieldMode::SmoothMin", EditConditionHides))
+	float SmoothMinBlend = 60;
+
+	/**
+	 * If true, only the cells connected to the surface near the probes are evaluated, instead of the whole grid over the probe
+	 * bounds. Time and memory then scale with the surface area. Only used with the NearestDistance field, where every part of
+	 * the surface encloses a probe; Metaball and SmoothMin blobs can form between probes that are not inside them.
+	 */
+	UPROPERTY(EditAnywhere, Category = MarchingCubes)
+	bool bSparseMarchingCubes = true;
 
+	/**
+	 * If true, the surface is kept in tiles between regenerations, and only the tiles near probes that moved or changed
+	 * value are re-polygonized and stitched into the existing mesh. Useful with bRegenerateOnTick. Tiles only exist near
+	 * the probes, so bSparseMarchingCubes has no effect in this mode.
+	 */
 	UPROPERTY(EditAnywhere, Category = MarchingCubes)
-	float IsoValue;
+	bool bIncrementalMarchingCubes = false;
+
+	//
+	// Boolean Options
+	//
+
+	/** If true, Subtraction and Union booleans only pass the part of SourceMesh that overlaps the tool bounds to FMeshBoolean and stitch the result back, so the cost scales with the overlap instead of the full mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = BooleanOptions)
+	bool bLocalizedBoolean = false;
+
+	/** Margin added around the tool bounds when extracting the localized region, as a multiple of the largest tool dimension. Larger margins make inside/outside classification against the partial region more reliable */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = BooleanOptions, meta = (UIMin = 0.5, UIMax = 4.0, EditCondition = "bLocalizedBoolean"))
+	float LocalizedBooleanMargin = 2.0;
 
+	/** If true, holes left open by a failed boolean are filled (with the same minimal fill as FillHole) as part of the boolean operation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = BooleanOptions)
+	bool bRepairFailedBooleans = true;
+
+	/** Result of the last boolean operation, including the hole repair counts */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = BooleanOptions)
+	FDynamicMeshBooleanResult LastBooleanResult;
 	
 
 	//
@@ -233,6 +354,11 @@ public:
 	virtual const FDynamicMesh3& GetMeshRef() const;
 
 
+	/**
+	 * @return revision counter of the SourceMesh, incremented each time the mesh is modified via EditMesh()
+	 */
+	uint64 GetMeshRevision() const;
+
 	/**
 	 * This delegate is broadcast whenever the internal SourceMesh is updated
 	 */
@@ -247,6 +373,9 @@ protected:
 	/** The SourceMesh used to initialize the mesh Components in the various subclasses */
 	FDynamicMesh3 SourceMesh;
 
+	/** Incremented each time SourceMesh is modified via EditMesh() */
+	uint64 MeshRevision = 0;
+
 	/** Accumulated time since Actor was created, this is used for the animated primitives when bRegenerateOnTick = true*/
 	double AccumulatedTime = 0;
 
@@ -256,6 +385,45 @@ protected:
 	/** Called to generate or import a new source mesh. Override this to provide your own generated mesh. */
 	virtual void RegenerateSourceMesh(FDynamicMesh3& MeshOut);
 
+	/** Triangulation of the Delaunay primitive, kept between regenerations so that changes to RandomPoints only update the affected triangles */
+	TSharedPtr<class FIncrementalDelaunayGenerator> IncrementalDelaunay;
+
+	/** MeshRevision of the SourceMesh last written by IncrementalDelaunay. If the mesh was edited since, it is rebuilt */
+	uint64 IncrementalDelaunayMeshRevision = 0;
+
+	/** Tiles of the MarchingCubes primitive, kept between regenerations when bIncrementalMarchingCubes is true */
+	TSharedPtr<class FTiledMarchingCubesGenerator> TiledMarchingCubes;
+
+	/** MeshRevision of the SourceMesh last written by TiledMarchingCubes, and the field settings it was built with */
+	uint64 TiledMarchingCubesMeshRevision = 0;
+	uint32 TiledMarchingCubesSettingsHash = 0;
+
+	/** Sphere/Box primitive of radius 1 with normals, keyed by the settings that change its topology or normals */
+	struct FCachedPrimitiveMesh
+	{
+		EDynamicMeshActorPrimitiveType PrimitiveType = EDynamicMeshActorPrimitiveType::Sphere;
+		int32 TessellationLevel = 0;
+		float BoxDepthRatio = 1;
+		EDynamicMeshActorNormalsMode NormalsMode = EDynamicMeshActorNormalsMode::SplitNormals;
+		TSharedPtr<FDynamicMesh3> UnitMesh;
+	};
+
+	/** Recently used primitive meshes, least-recently used first */
+	TArray<FCachedPrimitiveMesh> CachedPrimitiveMeshes;
+
+	static constexpr int32 MaxCachedPrimitiveMeshes = 4;
+
+	/** Unit mesh the SourceMesh was last scaled from, and the MeshRevision the SourceMesh had after that */
+	TSharedPtr<FDynamicMesh3> LastPrimitiveUnitMesh;
+	uint64 LastPrimitiveMeshRevision = 0;
+
+	/**
+	 * Write the Sphere or Box primitive with the given radius to MeshOut. The unit mesh is generated once per set of
+	 * topology settings and scaled. If MeshOut still holds the last scaled primitive, only its vertex positions are
+	 * rewritten; the normals stay valid since the scale is uniform.
+	 */
+	void GetScaledPrimitiveMesh(FDynamicMesh3& MeshOut, double Radius);
+
 	/** Call this on a Mesh to compute normals according to the NormalsMode setting */
 	virtual void RecomputeNormals(FDynamicMesh3& MeshOut);
 
@@ -392,6 +560,14 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void BooleanWithMesh(ADynamicMeshBaseActor* OtherMesh, EDynamicMeshActorBooleanOperation Operation);
 
+	/**
+	 * Compute the specified Boolean operation with all of OtherMeshes (transformed to world space) in a single pass.
+	 * The tool meshes are combined first (unioned, or intersected for Intersection) so the SourceMesh is only
+	 * cut once and the spatial data structures are only rebuilt once. Per-stage timings are written to the log.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void BooleanWithMeshes(const TArray<ADynamicMeshBaseActor*>& OtherMeshes, EDynamicMeshActorBooleanOperation Operation);
+
 	/** Subtract OtherMesh from our SourceMesh */
 	UFUNCTION(BlueprintCallable)
 	void SubtractMesh(ADynamicMeshBaseActor* OtherMesh);
@@ -404,6 +580,43 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void IntersectWithMesh(ADynamicMeshBaseActor* OtherMesh);
 
+protected:
+	/** SourceMesh of a tool Actor transformed into the local space of this Actor, with its bounds */
+	struct FCachedToolMesh
+	{
+		TWeakObjectPtr<ADynamicMeshBaseActor> ToolActor;
+		uint64 ToolMeshRevision = 0;
+		FTransform3d ToolToLocal;
+		TSharedPtr<FDynamicMesh3> Mesh;
+		FAxisAlignedBox3d Bounds;
+	};
+
+	/** Tool meshes used by recent booleans, keyed by (tool Actor, tool mesh revision, relative transform). Least-recently used first */
+	TArray<FCachedToolMesh> CachedToolMeshes;
+
+	static constexpr int32 MaxCachedToolMeshes = 8;
+
+	/**
+	 * Get the SourceMesh of ToolActor transformed into the local space of this Actor. The transformed mesh is cached,
+	 * so repeated booleans with the same tool (eg a carving tool) skip the copy and transform if neither the tool mesh
+	 * nor the relative transform changed.
+	 * @param CacheCapacity number of entries kept, so a call with several tools can keep all of them (at least MaxCachedToolMeshes)
+	 */
+	virtual FCachedToolMesh GetToolMeshInLocalSpace(ADynamicMeshBaseActor* ToolActor, int32 CacheCapacity = MaxCachedToolMeshes);
+
+	/** Compute Operation between TargetMesh and ToolMesh (both in our local space), and store the result in TargetMesh. @return false if the boolean failed */
+	virtual bool ApplyBooleanToMesh(FDynamicMesh3& TargetMesh, const FDynamicMesh3& ToolMesh, EDynamicMeshActorBooleanOperation Operation);
+
+	/**
+	 * Localized version of ApplyBooleanToMesh() used when bLocalizedBoolean is set: extracts the triangles of TargetMesh
+	 * overlapping the tool bounds, runs the boolean on that region only and stitches it back along the region boundary.
+	 * Not used for Intersection, which discards everything outside the tool anyway.
+	 * @return false if the localized boolean is not applicable (eg the region covers most of the mesh), in which case TargetMesh and ResultOut are unmodified
+	 */
+	virtual bool ApplyLocalizedBooleanToMesh(FDynamicMesh3& TargetMesh, const FDynamicMesh3& ToolMesh, EDynamicMeshActorBooleanOperation Operation, FDynamicMeshBooleanResult& ResultOut);
+
+public:
+
 	/** Create a "solid" verison of SourceMesh by voxelizing with the fast winding number at the given grid resolution */
 	UFUNCTION(BlueprintCallable)
 	void SolidifyMesh(int VoxelResolution = 64, float WindingThreshold = 0.5);
@@ -426,9 +639,28 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void FillHole(int32& NumFilledHoles, int32& NumFailedHoleFills);
 
+	/**
+	 * Report the attributes currently attached to SourceMesh (eg bIsShell) and the bytes each one uses.
+	 * The full report, including an estimate of the total mesh memory, is also written to the log.
+	 * @return total bytes used by attached attributes
+	 */
+	UFUNCTION(BlueprintCallable)
+	int64 GetAttributeMemoryReport(TMap<FName, int64>& AttributeBytes);
+
 	UFUNCTION(BlueprintCallable)
 	void WriteObj(const FString OutputPath);
 
+	/** Write the current mesh to a binary glTF (GLB) file, with one primitive per material/shell group */
+	UFUNCTION(BlueprintCallable)
+	bool WriteGlb(const FString OutputPath);
+
+	/**
+	 * Write the current mesh to an OBJ file on a background thread. The mesh is copied, so it can be edited while the file is written.
+	 * OnProgress and OnComplete are called on the game thread.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void WriteObjAsync(const FString OutputPath, FOnMeshExportProgress OnProgress, FOnMeshExportComplete OnComplete);
+
 	UFUNCTION(BlueprintCallable)
 	void PlaneCut(ADynamicMeshBaseActor* OtherMeshActor,FVector PlaneOrigin, FVector PlaneNormal, float GapWidth = 0, bool bFillCutHole = true, bool bFillSpans = false, bool bKeepBothHalves = true);
 	
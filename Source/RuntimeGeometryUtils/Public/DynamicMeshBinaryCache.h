@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+namespace RTGUtils
+{
+	/**
+	 * Path of the binary cache file for the given source file and import options, in Saved/RuntimeGeometryCache.
+	 * @param OptionsKey string identifying the import options that affect the mesh (eg orientation), so different settings get different cache files
+	 */
+	RUNTIMEGEOMETRYUTILS_API FString GetMeshCachePath(const FString& SourcePath, const FString& OptionsKey);
+
+	/**
+	 * Read the cached mesh for SourcePath/OptionsKey. The header is read first, the mesh only if the cache is valid.
+	 * The cache is only used if it was written for the same source file size and modification time, options and engine version.
+	 * @return false if there is no valid cache, in this case MeshOut is not modified
+	 */
+	RUNTIMEGEOMETRYUTILS_API bool ReadMeshCache(
+		const FString& SourcePath,
+		const FString& OptionsKey,
+		UE::Geometry::FDynamicMesh3& MeshOut);
+
+	/**
+	 * Write Mesh (vertices, triangles, overlays, triangle groups and serializable attached attributes) to the binary cache for SourcePath/OptionsKey.
+	 * @return false if the source file does not exist or the cache file could not be written
+	 */
+	RUNTIMEGEOMETRYUTILS_API bool WriteMeshCache(
+		const FString& SourcePath,
+		const FString& OptionsKey,
+		const UE::Geometry::FDynamicMesh3& Mesh);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+namespace RTGUtils
+{
+	/**
+	 * Write mesh to the given output path in binary glTF (GLB) format.
+	 * Positions, normals (primary normal overlay), UVs (primary UV overlay) and colors (primary color overlay,
+	 * or per-vertex colors) are written as packed float buffers. Triangles are split into one primitive per
+	 * (MaterialID, shell) group, where the shell flag is read from the bool triangle attribute ShellAttributeName
+	 * if the mesh has it, and stored in the primitive extras.
+	 * Coordinates are converted from UE (left-handed, Z up, centimeters) to glTF (right-handed, Y up, meters).
+	 * @param return false if write failed
+	 */
+	RUNTIMEGEOMETRYUTILS_API bool WriteGLBMesh(
+		const FString& OutputPath,
+		const UE::Geometry::FDynamicMesh3& Mesh,
+		FName ShellAttributeName = "bIsShell");
+}
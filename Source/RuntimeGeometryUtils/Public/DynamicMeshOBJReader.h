@@ -5,12 +5,30 @@
 
 namespace RTGUtils
 {
+	/**
+	 * Statistics about an OBJ file read by ReadOBJMesh()/ReadOBJMeshParallel()
+	 */
+	struct FOBJReadStats
+	{
+		int32 NumVertices = 0;
+		int32 NumTriangles = 0;
+		int32 NumTexCoords = 0;
+		int32 NumNormals = 0;
+		/** number of vertices that have a color in the file ("v x y z r g b") */
+		int32 NumColoredVertices = 0;
+		/** true if colors were imported into the mesh vertex colors */
+		bool bImportedVertexColors = false;
+		/** triangles that were dropped because of invalid indices or non-manifold topology */
+		int32 NumSkippedTriangles = 0;
+	};
+
 	/**
 	 * Read mesh in OBJ format from the given path into a FDynamicMesh3.
 	 * @param bNormals should normals be imported into primary normal attribute overlay
 	 * @param bTexCoords should texture coordinates be imported into primary UV attribute overlay
-	 * @param bVertexColors should normals be imported into per-vertex colors
+	 * @param bVertexColors should vertex colors be imported into per-vertex colors. Vertex colors are only enabled on the mesh if every vertex in the file has a color.
 	 * @param bReverseOrientation if true, mesh orientation/normals are flipped. You probably want this for importing to UE4 from other apps.
+	 * @param StatsOut if non-null, statistics about the file are returned here
 	 * @param return false if read failed
 	 */
 	RUNTIMEGEOMETRYUTILS_API bool ReadOBJMesh(
@@ -19,6 +37,23 @@ namespace RTGUtils
 		bool bNormals,
 		bool bTexCoords,
 		bool bVertexColors,
-		bool bReverseOrientation);
-}
+		bool bReverseOrientation,
+		FOBJReadStats* StatsOut = nullptr);
 
+	/**
+	 * Read mesh in OBJ format from the given path into a FDynamicMesh3, without going through tinyobj.
+	 * The file is memory-mapped (or read in one block if mapping is not available), split into line-aligned
+	 * chunks, and the v/vt/vn/f records of the chunks are parsed in parallel into flat arrays sized from a
+	 * counting pass, which are then appended to MeshOut. Other records (o/g/usemtl/mtllib/s/l/p) are ignored.
+	 * Parameters and result are the same as ReadOBJMesh(), except that vertex colors are enabled if any vertex
+	 * has a color (vertices without one are white). No color storage is allocated if the file has no colors.
+	 */
+	RUNTIMEGEOMETRYUTILS_API bool ReadOBJMeshParallel(
+		const FString& Path,
+		UE::Geometry::FDynamicMesh3& MeshOut,
+		bool bNormals,
+		bool bTexCoords,
+		bool bVertexColors,
+		bool bReverseOrientation,
+		FOBJReadStats* StatsOut = nullptr);
+}
@@ -26,6 +26,21 @@ namespace RTGUtils
 		const FString& OutputPath,
 		const TArray<FDynamicMesh3>& Meshes,
 		bool bReverseOrientation);
+
+	/**
+	 * Write set of meshes to the given output path in OBJ format on a background thread.
+	 * The meshes are shared with the writing thread, so they must not be modified until OnComplete is called
+	 * (pass copies of meshes that are being edited).
+	 * @param bReverseOrientation if true, mesh orientation/normals are flipped. You probably want this for exporting from UE4 to other apps.
+	 * @param OnProgress if set, called on the game thread with the fraction of the file written
+	 * @param OnComplete if set, called on the game thread when the file is written, with false if write failed
+	 */
+	RUNTIMEGEOMETRYUTILS_API void WriteOBJMeshesAsync(
+		const FString& OutputPath,
+		TArray<TSharedPtr<const FDynamicMesh3, ESPMode::ThreadSafe>> Meshes,
+		bool bReverseOrientation,
+		TFunction<void(float)> OnProgress = nullptr,
+		TFunction<void(bool)> OnComplete = nullptr);
 }
 
 
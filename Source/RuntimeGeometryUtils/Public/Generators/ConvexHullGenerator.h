@@ -3,12 +3,12 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Generators/MeshShapeGenerator.h"
+#include "ExtrudedPlanarGenerator.h"
 
 /**
  * 
  */
-class RUNTIMEGEOMETRYUTILS_API FConvexHullGenerator : UE::Geometry::FMeshShapeGenerator
+class RUNTIMEGEOMETRYUTILS_API FConvexHullGenerator : public FExtrudedPlanarGenerator
 {
 public:
 	// 在一个平面上的一组点
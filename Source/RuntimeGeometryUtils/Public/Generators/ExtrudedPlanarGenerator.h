@@ -0,0 +1,30 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Generators/MeshShapeGenerator.h"
+
+/**
+ * Base class of the generators that triangulate a set of 2D points into a flat sheet. If ExtrusionDepth > 0 the sheet
+ * is extruded downward into a closed solid, with a bottom cap and side walls along the boundary of the sheet.
+ */
+class RUNTIMEGEOMETRYUTILS_API FExtrudedPlanarGenerator : public UE::Geometry::FMeshShapeGenerator
+{
+public:
+	/** Thickness of the generated solid below the sheet, 0 outputs only the sheet */
+	double ExtrusionDepth = 0;
+
+	/** Polygon group IDs of the extruded parts */
+	static constexpr int32 TopPolygonID = 0;
+	static constexpr int32 BottomPolygonID = 1;
+	static constexpr int32 SidePolygonID = 2;
+
+protected:
+	/**
+	 * Extrude the flat sheet in the vertex/triangle buffers by ExtrusionDepth. The sheet triangles are oriented to face +Z,
+	 * a copy facing -Z is added ExtrusionDepth below, and each boundary edge of the sheet gets a side quad with its own
+	 * normals and UVs. Does nothing if ExtrusionDepth <= 0.
+	 */
+	void ExtrudeSheet();
+};
@@ -0,0 +1,60 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "../Algorithms/IncrementalDelaunay2.h"
+
+/**
+ * Delaunay generator that keeps its triangulation alive between regenerations. SetInput() applies only the
+ * differences to the previous input (moved, added and removed points, changed constraint edges) to the
+ * triangulation, and UpdateMesh() only removes and appends the triangles that changed.
+ * Constraint edges that form closed loops define the filled region, with holes (see FIncrementalDelaunay2::bFillByParity).
+ */
+class RUNTIMEGEOMETRYUTILS_API FIncrementalDelaunayGenerator
+{
+public:
+	/** Z coordinate of the generated vertices */
+	double Height = 20;
+
+	/** If > 0 the filled region is extruded downward into a solid (see FExtrudedPlanarGenerator). The extruded mesh is rebuilt on every update */
+	double ExtrusionDepth = 0;
+
+	/**
+	 * Update the triangulation to the given points and constraint edges. Constraint edges are pairs of indices into Points,
+	 * invalid pairs are skipped.
+	 */
+	void SetInput(const TArray<FVector2f>& Points, const TArray<FIntPoint>& Constraints);
+
+	/**
+	 * Apply the triangles that changed since the last update to Mesh. Mesh must be the mesh of the last update,
+	 * unless bFullRebuild is true, in which case Mesh is cleared and all triangles are emitted.
+	 * @return the number of triangles that were removed or appended
+	 */
+	int32 UpdateMesh(UE::Geometry::FDynamicMesh3& Mesh, bool bFullRebuild);
+
+	FIncrementalDelaunay2& GetTriangulation() { return Triangulation; }
+
+protected:
+	FIncrementalDelaunay2 Triangulation;
+
+	TArray<FVector2f> CurrentPoints;
+	TArray<int32> PointVertexIDs;
+	TArray<FIntPoint> CurrentConstraints;
+
+	// triangulation vertex/triangle ID -> mesh vertex/triangle ID
+	TArray<int32> VertexToMeshVertex;
+	TArray<int32> VertexUVElements;
+	TArray<int32> VertexNormalElements;
+	TArray<int32> TriangleToMeshTriangle;
+
+	// mesh vertices of removed triangulation vertices, removed in the next UpdateMesh
+	TArray<int32> RemovedMeshVertices;
+
+	// true if the last update wrote an extruded mesh, which can't be patched
+	bool bMeshIsExtruded = false;
+
+	void RemoveTriangulationVertex(int32 VertexID);
+	int32 GetOrAddMeshVertex(UE::Geometry::FDynamicMesh3& Mesh, int32 VertexID);
+};
@@ -3,12 +3,12 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Generators/MeshShapeGenerator.h"
+#include "ExtrudedPlanarGenerator.h"
 
 /**
  * 
  */
-class RUNTIMEGEOMETRYUTILS_API FRandomPointsMeshGenerator : public UE::Geometry::FMeshShapeGenerator
+class RUNTIMEGEOMETRYUTILS_API FRandomPointsMeshGenerator : public FExtrudedPlanarGenerator
 {
 public:
 
@@ -26,11 +26,25 @@ public:
 
 	// ConvexHull三角形 - 索引存储的是 ConvexHullVertices的索引
 	TArray<UE::Geometry::FIndex3i> Triangles2D;
+
+	// Triangles2D的邻接三角形, 第e个是边(Tri[e], Tri[(e+1)%3])对面的三角形, -1表示凸包边界
+	TArray<UE::Geometry::FIndex3i> TriangleNeighbors2D;
 	
 	// ConvexHull的顶点
 	TArray<FVector2f> ConvexHullVertices;
 
 	// ConvexHull 顶点的索引
 	TArray<int32> ConvexHullIndices;
+
+protected:
+
+	/** Build TriangleNeighbors2D for the initial hull triangulation */
+	void BuildTriangleNeighbors();
+
+	/** Split triangle TriangleIndex into three triangles around VertexIndex, keeping the adjacency up to date */
+	void SplitTriangle(int32 TriangleIndex, int32 VertexIndex);
+
+	/** Split edge Edge of triangle TriangleIndex, and the neighbor triangle across it if any, at VertexIndex */
+	void SplitEdge(int32 TriangleIndex, int32 Edge, int32 VertexIndex);
 	
 };
@@ -0,0 +1,95 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+/**
+ * Marching cubes over a fixed lattice of CubeSize cells, grouped into tiles of TileCells^3 cells, for surfaces defined
+ * by a field around a set of probes. The samples and triangles of each tile are kept between updates: when probes move,
+ * only the tiles within their influence radius are re-sampled, and only the tiles whose samples changed are
+ * re-polygonized. Vertices are keyed by their lattice edge, so re-polygonized tiles stay stitched to their neighbors.
+ *
+ * Tiles only exist within the surface distance of a probe, so the cost scales with the region around the probes
+ * instead of their bounding volume. Inside is where the field is >= IsoValue, triangles face outward.
+ */
+class RUNTIMEGEOMETRYUTILS_API FTiledMarchingCubesGenerator
+{
+public:
+	/** Field to polygonize. Called from parallel workers during UpdateMesh() */
+	TFunction<double(const FVector3d&)> Implicit;
+
+	double IsoValue = 0;
+	double CubeSize = 10;
+	int32 TileCells = 16;
+
+	/** Bisection steps to refine each edge crossing, 0 for linear interpolation of the samples */
+	int32 RootModeSteps = 4;
+
+	bool bParallelCompute = true;
+
+	/**
+	 * Update the probes. Probes are matched to the previous call by index. Tiles within SurfaceDistance of a probe are
+	 * kept, other tiles are dropped. Tiles within InfluenceRadius of a probe that was moved, added, removed or changed
+	 * value are re-sampled in the next UpdateMesh().
+	 */
+	void SetProbes(TArrayView<const FVector3d> Positions, TArrayView<const double> Values, double InfluenceRadius, double SurfaceDistance);
+
+	/**
+	 * Re-sample the tiles marked by SetProbes() and apply the re-polygonized tiles to Mesh. Mesh must be the mesh of the
+	 * last update, unless bFullRebuild is true, in which case Mesh is cleared and all tiles are re-sampled.
+	 * @return the number of re-polygonized tiles
+	 */
+	int32 UpdateMesh(UE::Geometry::FDynamicMesh3& Mesh, bool bFullRebuild);
+
+	int32 NumTiles() const { return Tiles.Num(); }
+
+protected:
+	/** Lattice edge starting at lattice point Point along Axis */
+	struct FEdgeKey
+	{
+		FIntVector Point;
+		int32 Axis = 0;
+
+		bool operator==(const FEdgeKey& Other) const { return Point == Other.Point && Axis == Other.Axis; }
+		friend uint32 GetTypeHash(const FEdgeKey& Key) { return HashCombine(GetTypeHash(Key.Point), GetTypeHash(Key.Axis)); }
+	};
+
+	struct FTile
+	{
+		int32 NumProbes = 0;			// probes whose surface region overlaps the tile
+		bool bDirty = true;
+		bool bPolygonized = false;
+		TArray<float> Samples;			// (TileCells+1)^3 field values at the lattice points, X fastest
+		TArray<int32> MeshTriangles;
+		TArray<FEdgeKey> EdgeKeys;		// lattice edges of the vertices used by MeshTriangles, each once
+	};
+	TMap<FIntVector, FTile> Tiles;
+
+	struct FEdgeVertex
+	{
+		int32 VertexID = -1;
+		int32 NumTiles = 0;
+	};
+	TMap<FEdgeKey, FEdgeVertex> EdgeVertices;
+
+	struct FTileResult;
+
+	TArray<FVector3d> ProbePositions;
+	TArray<double> ProbeValues;
+
+	// layout the tiles were built with, tiles are rebuilt if it changes
+	double TilesCubeSize = 0;
+	int32 TilesTileCells = 0;
+	double TilesInfluenceRadius = 0;
+	double TilesSurfaceDistance = 0;
+	bool bNeedsFullRebuild = true;
+
+	void GetTileRange(const FVector3d& Center, double Radius, FIntVector& MinTile, FIntVector& MaxTile) const;
+	void AddProbeToTiles(const FVector3d& Position, int32 Delta);
+	void MarkTilesDirty(const FVector3d& Position);
+
+	/** Remove the triangles of the tile, and the vertices no other tile uses */
+	void ReleaseTile(UE::Geometry::FDynamicMesh3& Mesh, FTile& Tile);
+};
@@ -18,15 +18,24 @@ public:
 	// Sets default values for this actor's properties
 	AImportedFBXActor();
 
-	void AddMeshComponent(FName MeshName, FDynamicMesh3& SourceMesh);
+	/** Add a static mesh component built from SourceMesh, with the given transform relative to the actor */
+	void AddMeshComponent(FName MeshName, FDynamicMesh3& SourceMesh, const FTransform& Transform = FTransform::Identity);
+
+	/** Add an instanced static mesh component built from SourceMesh, with one instance per transform */
+	void AddInstancedMeshComponent(FName MeshName, FDynamicMesh3& SourceMesh, const TArray<FTransform>& InstanceTransforms);
 
 	UPROPERTY(VisibleAnywhere)
 	TArray<class UStaticMeshComponent*> MeshComponents;
 
+	UPROPERTY(VisibleAnywhere)
+	TArray<class UInstancedStaticMeshComponent*> InstancedMeshComponents;
+
 	UFUNCTION(BlueprintCallable)
 	int32 CountComponents();
 
 protected:
+	UStaticMesh* CreateStaticMesh(FDynamicMesh3& SourceMesh);
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
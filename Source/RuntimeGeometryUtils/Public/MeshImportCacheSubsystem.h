@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "MeshImportCacheSubsystem.generated.h"
+
+using namespace UE::Geometry;
+
+/**
+ * UMeshImportCacheSubsystem holds imported meshes in memory so that all actors importing the same file
+ * with the same settings share one parse/post-process. Cached meshes are immutable and shared, users copy
+ * them into their own mesh. When the cached meshes exceed MemoryBudgetMB, the least-recently-used ones are evicted.
+ *
+ * The cache is thread-safe, but meshes are built outside the lock, so two threads requesting the same
+ * missing key at the same time may both build it (the first one is kept).
+ */
+UCLASS(Config = RuntimeGeometryUtils)
+class RUNTIMEGEOMETRYUTILS_API UMeshImportCacheSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Memory budget for cached meshes, in megabytes */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = ImportCache)
+	int32 MemoryBudgetMB = 512;
+
+	/** @return the subsystem of the running engine, or nullptr if the engine is not initialized */
+	static UMeshImportCacheSubsystem* Get();
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Return the mesh cached for Key. If there is none, BuildMesh is called to create it and the result is added to the cache.
+	 * @param BuildMesh fills the mesh, returns false on failure (failures are not cached)
+	 * @return shared mesh, or nullptr if BuildMesh failed
+	 */
+	TSharedPtr<const FDynamicMesh3> FindOrBuild(const FString& Key, TFunctionRef<bool(FDynamicMesh3&)> BuildMesh);
+
+	/** @return the mesh cached for Key, or nullptr */
+	TSharedPtr<const FDynamicMesh3> Find(const FString& Key);
+
+	/** Remove all cached meshes. Meshes still referenced elsewhere stay alive until released. */
+	UFUNCTION(BlueprintCallable, Category = ImportCache)
+	void ClearImportCache();
+
+	/** @return estimated memory used by the cached meshes, in bytes */
+	UFUNCTION(BlueprintCallable, Category = ImportCache)
+	int64 GetCachedBytes() const;
+
+	/** @return number of cached meshes */
+	UFUNCTION(BlueprintCallable, Category = ImportCache)
+	int32 GetNumCachedMeshes() const;
+
+protected:
+	struct FCachedImport
+	{
+		FString Key;
+		TSharedPtr<const FDynamicMesh3> Mesh;
+		int64 Bytes = 0;
+	};
+
+	/** cached meshes, most recently used last */
+	TArray<FCachedImport> CachedImports;
+	int64 CachedBytes = 0;
+	mutable FCriticalSection CacheLock;
+
+	/** Remove least-recently-used meshes until the budget is met, always keeping the most recent one. Must be called with CacheLock held. */
+	void EvictToBudget();
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+namespace RTGUtils
+{
+	/**
+	 * Fill the open boundary loops of Mesh in place, using the same fill as FHoleFillOp with
+	 * EHoleFillOpFillType::Minimal and bQuickFillSmallHoles (triangle fan for loops of 3 vertices).
+	 * Unlike FHoleFillOp this does not copy the mesh. Normals are set on the new triangles if the mesh has attributes.
+	 * @param OnlyLoopsWithEdges if non-null, only loops containing at least one of these edges are filled (eg the edges left open by a failed boolean), other open boundaries are preserved
+	 * @param NumFilledHoles number of loops that were filled
+	 * @param NumFailedHoleFills number of loops that could not be filled
+	 */
+	RUNTIMEGEOMETRYUTILS_API void FillMeshHoles(
+		UE::Geometry::FDynamicMesh3& Mesh,
+		int32& NumFilledHoles,
+		int32& NumFailedHoleFills,
+		const TArray<int>* OnlyLoopsWithEdges = nullptr);
+}
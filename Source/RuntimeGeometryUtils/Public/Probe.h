@@ -16,7 +16,7 @@ public:
 	AProbe();
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	float Value;
+	float Value = 1.0f;
 
 protected:
 	// Called when the game starts or when spawned